@@ -0,0 +1,98 @@
+#include "CompiledMap.h"
+#include <iostream>
+#include <cstring>
+
+CompiledMap::CompiledMap(): mapWidth(0), mapHeight(0), tileWidth(0), tileHeight(0), mapData(NULL),
+    tilesets(NULL), tilesetCount(0), layers(NULL), layerCount(0) {}
+
+// a table of count entries at offset has to lie inside the file and be aligned for in-place reads
+static bool TableFits(uint64_t offset, uint64_t count, uint64_t entrySize, size_t fileSize) {
+    return offset % 4 == 0 && offset + count * entrySize <= fileSize;
+}
+
+bool CompiledMap::Validate(const char *path) const {
+    const uint32_t one = 1;
+    if (*(const unsigned char *)&one != 1) {
+        std::cout << "Compiled maps are little-endian and can not be used in place on this machine" << std::endl;
+        return false;
+    }
+    if (file.size < sizeof(CompiledMapHeader) || memcmp(file.data, COMPILED_MAP_MAGIC, 4) != 0) {
+        std::cout << path << " is not a compiled map" << std::endl;
+        return false;
+    }
+    const CompiledMapHeader *header = (const CompiledMapHeader *)file.data;
+    if (header->version != COMPILED_MAP_VERSION) {
+        std::cout << "Compiled map " << path << " has version " << header->version << ", expected " << COMPILED_MAP_VERSION << std::endl;
+        return false;
+    }
+    if (!TableFits(header->tilesetOffset, header->tilesetCount, sizeof(CompiledTileset), file.size) ||
+        !TableFits(header->layerOffset, header->layerCount, sizeof(CompiledLayer), file.size)) {
+        std::cout << "Compiled map " << path << " is truncated" << std::endl;
+        return false;
+    }
+    const CompiledLayer *fileLayers = (const CompiledLayer *)(file.data + header->layerOffset);
+    uint64_t tileCount = (uint64_t)header->width * header->height;
+    for (uint32_t i = 0; i < header->layerCount; i++) {
+        if (!TableFits(fileLayers[i].dataOffset, tileCount, sizeof(uint32_t), file.size)) {
+            std::cout << "Compiled map " << path << " is truncated" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CompiledMap::Load(const char *path) {
+    Close();
+    if (!file.Open(path)) {
+        return false;
+    }
+    if (!Validate(path)) {
+        Close();
+        return false;
+    }
+
+    const CompiledMapHeader *header = (const CompiledMapHeader *)file.data;
+    mapWidth = (int)header->width;
+    mapHeight = (int)header->height;
+    tileWidth = (int)header->tileWidth;
+    tileHeight = (int)header->tileHeight;
+    tilesets = (const CompiledTileset *)(file.data + header->tilesetOffset);
+    tilesetCount = (int)header->tilesetCount;
+    layers = (const CompiledLayer *)(file.data + header->layerOffset);
+    layerCount = (int)header->layerCount;
+
+    // only the row pointers are built here, the tiles themselves stay in the mapping
+    if (layerCount > 0) {
+        const unsigned int *tiles = LayerData(0);
+        rows.resize(mapHeight);
+        for (int y = 0; y < mapHeight; y++) {
+            rows[y] = tiles + (size_t)y * mapWidth;
+        }
+        mapData = rows.data();
+    }
+    return true;
+}
+
+void CompiledMap::Close() {
+    file.Close();
+    rows.clear();
+    mapData = NULL;
+    tilesets = NULL;
+    layers = NULL;
+    mapWidth = mapHeight = 0;
+    tileWidth = tileHeight = 0;
+    tilesetCount = layerCount = 0;
+}
+
+int CompiledMap::FindLayer(const char *name) const {
+    for (int i = 0; i < layerCount; i++) {
+        if (strncmp(layers[i].name, name, COMPILED_MAP_NAME_LENGTH) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const unsigned int *CompiledMap::LayerData(int layer) const {
+    return (const unsigned int *)(file.data + layers[layer].dataOffset);
+}
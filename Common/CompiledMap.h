@@ -0,0 +1,77 @@
+#pragma once
+
+#include "MappedFile.h"
+#include <vector>
+#include <cstdint>
+
+#define COMPILED_MAP_MAGIC "PGMP"
+#define COMPILED_MAP_VERSION 1
+#define COMPILED_MAP_NAME_LENGTH 64
+
+// Layout of a .map file written by MapCompiler. Every field is little-endian
+// and every table starts on a 4-byte boundary, so the file can be used in
+// place once it is mapped. Offsets count bytes from the start of the file.
+struct CompiledMapHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t tileWidth;
+    uint32_t tileHeight;
+    uint32_t tilesetCount;
+    uint32_t layerCount;
+    uint32_t tilesetOffset;
+    uint32_t layerOffset;
+};
+
+// one "tileset=image,tile width,tile height,offset x,offset y" line
+struct CompiledTileset {
+    char image[COMPILED_MAP_NAME_LENGTH];
+    uint32_t tileWidth;
+    uint32_t tileHeight;
+    uint32_t offsetX;
+    uint32_t offsetY;
+};
+
+struct CompiledLayer {
+    char name[COMPILED_MAP_NAME_LENGTH];
+    // width * height tile values, row by row from the top
+    uint32_t dataOffset;
+    uint32_t reserved;
+};
+
+// Runtime side of MapCompiler: maps a compiled level and reads its tiles
+// straight out of the mapping. Tile values are the ones FlareMap stores,
+// the Tiled id minus one with empty tiles as 0, so mapData can stand in
+// for FlareMap::mapData.
+class CompiledMap {
+    public:
+
+        CompiledMap();
+
+        bool Load(const char *path);
+        void Close();
+
+        // index of the layer with this name, or -1
+        int FindLayer(const char *name) const;
+        const unsigned int *LayerData(int layer) const;
+
+        int mapWidth;
+        int mapHeight;
+        int tileWidth;
+        int tileHeight;
+        // rows of the first layer, pointing into the mapping
+        const unsigned int *const *mapData;
+
+        const CompiledTileset *tilesets;
+        int tilesetCount;
+        const CompiledLayer *layers;
+        int layerCount;
+
+    private:
+
+        bool Validate(const char *path) const;
+
+        MappedFile file;
+        std::vector<const unsigned int *> rows;
+};
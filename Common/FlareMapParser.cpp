@@ -0,0 +1,255 @@
+#include "FlareMapParser.h"
+#include "MappedFile.h"
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+
+FlareMapParser::FlareMapParser(): mapWidth(0), mapHeight(0), tileWidth(0), tileHeight(0), mapData(NULL) {}
+
+// the line at cursor without its line break, cursor moves to the start of the next one
+static void NextLine(const char *&cursor, const char *end, const char *&line, const char *&lineEnd) {
+    line = cursor;
+    const char *newline = (const char *)memchr(cursor, '\n', end - cursor);
+    lineEnd = newline != NULL ? newline : end;
+    cursor = newline != NULL ? newline + 1 : end;
+    if (lineEnd > line && lineEnd[-1] == '\r') {
+        lineEnd--;
+    }
+}
+
+static bool Equals(const char *start, const char *stop, const char *literal) {
+    size_t length = strlen(literal);
+    return (size_t)(stop - start) == length && memcmp(start, literal, length) == 0;
+}
+
+// reads the unsigned decimal number at cursor and moves past it, false if there is none
+static inline bool ScanNumber(const char *&cursor, const char *end, unsigned int &value) {
+    const char *start = cursor;
+    value = 0;
+    while (cursor < end && (unsigned char)(*cursor - '0') < 10) {
+        value = value * 10 + (unsigned int)(*cursor - '0');
+        cursor++;
+    }
+    return cursor != start;
+}
+
+static int ScanInt(const char *cursor, const char *end) {
+    unsigned int value;
+    return ScanNumber(cursor, end, value) ? (int)value : 0;
+}
+
+// image,tile width,tile height,offset x,offset y
+static bool ParseTileset(const char *cursor, const char *end, FlareMapTileset &tileset) {
+    const char *comma = (const char *)memchr(cursor, ',', end - cursor);
+    if (comma == NULL) {
+        return false;
+    }
+    tileset.image.assign(cursor, comma);
+    unsigned int fields[4] = {0, 0, 0, 0};
+    cursor = comma + 1;
+    for (int i = 0; i < 4 && cursor < end; i++) {
+        if (!ScanNumber(cursor, end, fields[i]) && i < 2) {
+            return false;
+        }
+        if (cursor < end && *cursor == ',') {
+            cursor++;
+        }
+    }
+    tileset.tileWidth = (int)fields[0];
+    tileset.tileHeight = (int)fields[1];
+    tileset.offsetX = (int)fields[2];
+    tileset.offsetY = (int)fields[3];
+    return true;
+}
+
+bool FlareMapParser::ParseLayerData(const char *&cursor, const char *end, FlareMapLayer &layer, const char *name) {
+    if (mapWidth <= 0 || mapHeight <= 0) {
+        std::cout << "Layer data before the map size in " << name << std::endl;
+        return false;
+    }
+    // the same size as last time reuses the storage as it is
+    layer.tiles.resize((size_t)mapWidth * mapHeight);
+    unsigned int *tile = layer.tiles.data();
+    unsigned int *last = tile + layer.tiles.size();
+
+    // the values are read as one stream, so how the rows are broken into lines does not matter
+    const char *p = cursor;
+    while (tile < last) {
+        while (p < end && (*p == ',' || *p == '\n' || *p == '\r' || *p == ' ')) {
+            p++;
+        }
+        unsigned int value;
+        if (!ScanNumber(p, end, value)) {
+            if (p == end || *p == '[') {
+                std::cout << "Layer " << layer.name << " in " << name << " has fewer than " << mapWidth << " x " << mapHeight << " tiles" << std::endl;
+            } else {
+                std::cout << "Unexpected '" << *p << "' in layer " << layer.name << " of " << name << std::endl;
+            }
+            return false;
+        }
+        *tile++ = value > 0 ? value - 1 : 0;
+    }
+
+    // whatever is left of the last row
+    const char *newline = (const char *)memchr(p, '\n', end - p);
+    cursor = newline != NULL ? newline + 1 : end;
+    return true;
+}
+
+bool FlareMapParser::Load(const char *path) {
+    MappedFile file;
+    if (!file.Open(path)) {
+        return false;
+    }
+    return Parse((const char *)file.data, file.size, path);
+}
+
+bool FlareMapParser::Parse(const char *text, size_t size, const char *name) {
+    enum Section {SECTION_NONE, SECTION_HEADER, SECTION_TILESETS, SECTION_LAYER, SECTION_OTHER};
+
+    mapWidth = mapHeight = tileWidth = tileHeight = 0;
+    mapData = NULL;
+    tilesets.clear();
+    // layers are overwritten in place and only trimmed at the end, which keeps their tile storage
+    size_t layerCount = 0;
+    Section section = SECTION_NONE;
+
+    const char *cursor = text;
+    const char *end = text + size;
+    while (cursor < end) {
+        const char *line, *lineEnd;
+        NextLine(cursor, end, line, lineEnd);
+        if (line == lineEnd) {
+            continue;
+        }
+        if (*line == '[') {
+            if (Equals(line, lineEnd, "[header]")) {
+                section = SECTION_HEADER;
+            } else if (Equals(line, lineEnd, "[tilesets]")) {
+                section = SECTION_TILESETS;
+            } else if (Equals(line, lineEnd, "[layer]")) {
+                section = SECTION_LAYER;
+                if (layerCount == layers.size()) {
+                    layers.push_back(FlareMapLayer());
+                }
+                layers[layerCount].name.clear();
+                layerCount++;
+            } else {
+                // object layers, nothing here uses them
+                section = SECTION_OTHER;
+            }
+            continue;
+        }
+        const char *equals = (const char *)memchr(line, '=', lineEnd - line);
+        if (equals == NULL) {
+            continue;
+        }
+        const char *value = equals + 1;
+
+        if (section == SECTION_HEADER) {
+            if (Equals(line, equals, "width")) {
+                mapWidth = ScanInt(value, lineEnd);
+            } else if (Equals(line, equals, "height")) {
+                mapHeight = ScanInt(value, lineEnd);
+            } else if (Equals(line, equals, "tilewidth")) {
+                tileWidth = ScanInt(value, lineEnd);
+            } else if (Equals(line, equals, "tileheight")) {
+                tileHeight = ScanInt(value, lineEnd);
+            }
+        } else if (section == SECTION_TILESETS && Equals(line, equals, "tileset")) {
+            FlareMapTileset tileset;
+            if (!ParseTileset(value, lineEnd, tileset)) {
+                std::cout << "Bad tileset line in " << name << ": " << std::string(line, lineEnd) << std::endl;
+                return false;
+            }
+            tilesets.push_back(tileset);
+        } else if (section == SECTION_LAYER) {
+            FlareMapLayer &layer = layers[layerCount - 1];
+            if (Equals(line, equals, "type")) {
+                layer.name.assign(value, lineEnd);
+            } else if (Equals(line, equals, "data") && !ParseLayerData(cursor, end, layer, name)) {
+                return false;
+            }
+        }
+    }
+    layers.resize(layerCount);
+
+    if (mapWidth <= 0 || mapHeight <= 0) {
+        std::cout << name << " has no map size in its header" << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < layers.size(); i++) {
+        if (layers[i].tiles.size() != (size_t)mapWidth * mapHeight) {
+            std::cout << "Layer " << layers[i].name << " in " << name << " has no data" << std::endl;
+            return false;
+        }
+    }
+    if (!layers.empty()) {
+        rows.resize(mapHeight);
+        for (int y = 0; y < mapHeight; y++) {
+            rows[y] = &layers[0].tiles[(size_t)y * mapWidth];
+        }
+        mapData = rows.data();
+    }
+    return true;
+}
+
+static void AppendNumber(std::string &text, unsigned int value) {
+    char digits[10];
+    int count = 0;
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (count > 0) {
+        text += digits[--count];
+    }
+}
+
+// Tiled ids, one more than the values HW4 and HW5 test for
+#define GENERATED_GROUND_TOP 123
+#define GENERATED_GROUND 153
+#define GENERATED_TILE_COUNT 480
+
+void GenerateFlareMapText(int width, int height, int layerCount, unsigned int seed, std::string &text) {
+    srand(seed);
+    // most tiles are "0," and ground a few characters more
+    text.reserve(text.size() + (size_t)width * height * layerCount * 3 + 256);
+
+    text += "[header]\nwidth=";
+    AppendNumber(text, (unsigned int)width);
+    text += "\nheight=";
+    AppendNumber(text, (unsigned int)height);
+    text += "\ntilewidth=21\ntileheight=21\norientation=orthogonal\nbackground_color=0,0,0,255\n\n";
+    text += "[tilesets]\ntileset=spritesheet.png,21,21,0,0\n";
+
+    int groundTop = height - height / 8 - 1;
+    for (int layer = 0; layer < layerCount; layer++) {
+        text += "\n[layer]\ntype=Tile Layer ";
+        AppendNumber(text, (unsigned int)layer + 1);
+        text += "\ndata=\n";
+        for (int y = 0; y < height; y++) {
+            int platformLeft = 0;
+            for (int x = 0; x < width; x++) {
+                unsigned int tile = 0;
+                if (layer == 0 && y > groundTop) {
+                    tile = GENERATED_GROUND;
+                } else if (layer == 0 && y == groundTop) {
+                    // gaps to jump over
+                    tile = rand() % 12 == 0 ? 0 : GENERATED_GROUND_TOP;
+                } else if (layer == 0 && y % 4 == 0 && (platformLeft > 0 || rand() % 24 == 0)) {
+                    platformLeft = platformLeft > 0 ? platformLeft - 1 : 2 + rand() % 6;
+                    tile = GENERATED_GROUND_TOP;
+                } else if (rand() % 16 == 0) {
+                    tile = 1 + rand() % GENERATED_TILE_COUNT;
+                }
+                AppendNumber(text, tile);
+                // Tiled ends every row but the last with a comma
+                if (x < width - 1 || y < height - 1) {
+                    text += ',';
+                }
+            }
+            text += '\n';
+        }
+    }
+}
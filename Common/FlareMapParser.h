@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// "tileset=image,tile width,tile height,offset x,offset y"
+struct FlareMapTileset {
+    std::string image;
+    int tileWidth;
+    int tileHeight;
+    int offsetX;
+    int offsetY;
+};
+
+struct FlareMapLayer {
+    std::string name;
+    // mapWidth * mapHeight tile values, row by row from the top
+    std::vector<unsigned int> tiles;
+};
+
+// Reads Tiled text exports, the [header], [tilesets] and [layer] files
+// FlareMap loads, in one pass over a mapped buffer. data= rows go through a
+// hand-rolled integer scanner instead of streams, and tile storage is kept
+// between loads, so parsing another map of the same size allocates nothing
+// for its tiles. Values are stored the way FlareMap stores them, the Tiled
+// id minus one with empty tiles as 0, and mapData has FlareMap's [y][x] shape.
+class FlareMapParser {
+    public:
+
+        FlareMapParser();
+
+        // maps the file and parses it, the tiles are copied out so the file is closed again
+        bool Load(const char *path);
+        // name only shows up in error messages
+        bool Parse(const char *text, size_t size, const char *name);
+
+        int mapWidth;
+        int mapHeight;
+        int tileWidth;
+        int tileHeight;
+        // rows of the first layer
+        const unsigned int *const *mapData;
+
+        std::vector<FlareMapTileset> tilesets;
+        std::vector<FlareMapLayer> layers;
+
+    private:
+
+        bool ParseLayerData(const char *&cursor, const char *end, FlareMapLayer &layer, const char *name);
+
+        std::vector<const unsigned int *> rows;
+};
+
+// Appends a synthetic level of the given size to text, in the same format,
+// for MapGenerator and Benchmark. Rows of ground and floating platforms over
+// mostly empty sky, like a platformer level, from a fixed seed.
+void GenerateFlareMapText(int width, int height, int layerCount, unsigned int seed, std::string &text);
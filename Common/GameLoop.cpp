@@ -0,0 +1,41 @@
+#include "GameLoop.h"
+
+GameLoop::GameLoop(float updateRate, float renderRate, int maxSteps): timestep(1.0f / updateRate), renderInterval(renderRate > 0.0f ? 1.0f / renderRate : 0.0f), maxSteps(maxSteps), frameTime(0.0f), accumulator(0.0f), droppedTime(0.0f), lastFrame(0), frameStart(0) {}
+
+int GameLoop::BeginFrame() {
+    Uint64 now = SDL_GetPerformanceCounter();
+    float elapsed = lastFrame == 0 ? timestep : (float)((double)(now - lastFrame) / (double)SDL_GetPerformanceFrequency());
+    lastFrame = now;
+    return BeginFrame(elapsed);
+}
+
+int GameLoop::BeginFrame(float elapsed) {
+    frameStart = SDL_GetPerformanceCounter();
+    frameTime = elapsed;
+    accumulator += elapsed;
+
+    int steps = (int)(accumulator / timestep);
+    if (steps > maxSteps) {
+        droppedTime += (steps - maxSteps) * timestep;
+        accumulator -= (steps - maxSteps) * timestep;
+        steps = maxSteps;
+    }
+    accumulator -= steps * timestep;
+    return steps;
+}
+
+void GameLoop::EndFrame() {
+    if (renderInterval <= 0.0f) {
+        return;
+    }
+    // sleep rather than spin until the next frame is due, leaving the last millisecond to the scheduler
+    float spent = (float)((double)(SDL_GetPerformanceCounter() - frameStart) / (double)SDL_GetPerformanceFrequency());
+    float remaining = renderInterval - spent;
+    if (remaining > 0.001f) {
+        SDL_Delay((Uint32)((remaining - 0.001f) * 1000.0f));
+    }
+}
+
+float GameLoop::Alpha() const {
+    return accumulator / timestep;
+}
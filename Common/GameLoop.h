@@ -0,0 +1,44 @@
+#pragma once
+
+#include <SDL.h>
+
+// Fixed timestep clock for the main loop. Real frame time goes into an
+// accumulator that is spent in whole simulation steps, so the simulation runs
+// at updateRate no matter how fast frames are drawn. Alpha() is how far the
+// leftover time reaches into the next step, for drawing each entity between
+// its previous and current position.
+//
+//     int steps = loop.BeginFrame();
+//     for (int i = 0; i < steps; i++) { save previous state; Update(loop.timestep); }
+//     draw at loop.Alpha(); swap; loop.EndFrame();
+class GameLoop {
+    public:
+
+        // renderRate 0 leaves pacing to vsync, otherwise EndFrame sleeps off the rest of each frame
+        GameLoop(float updateRate = 60.0f, float renderRate = 0.0f, int maxSteps = 8);
+
+        // measures the time since the last frame, returns the number of steps to simulate
+        int BeginFrame();
+        // same with a caller supplied frame time, used by headless runs
+        int BeginFrame(float elapsed);
+        void EndFrame();
+
+        float Alpha() const;
+
+        float timestep;
+        float renderInterval;
+        // steps allowed per frame; after a long hitch the extra time is dropped
+        // instead of being simulated, which would make the next frame longer still
+        int maxSteps;
+
+        // real time of the last frame, for effects that do not need a fixed step
+        float frameTime;
+        float accumulator;
+        // simulation time thrown away by the clamp since startup
+        float droppedTime;
+
+    private:
+
+        Uint64 lastFrame;
+        Uint64 frameStart;
+};
@@ -0,0 +1,89 @@
+#include "HandlePool.h"
+
+#define NO_SLOT 0xFFFFFFFFu
+
+HandleTable::HandleTable(): firstFree(NO_SLOT), count(0) {}
+
+void HandleTable::Reset(size_t capacity) {
+    slots.resize(capacity);
+    indexToSlot.resize(capacity);
+    // chain every slot into the free list, bumping generations so old handles stay invalid
+    for (size_t i = 0; i < capacity; i++) {
+        slots[i].generation++;
+        slots[i].index = i + 1 < capacity ? (unsigned int)(i + 1) : NO_SLOT;
+    }
+    firstFree = capacity > 0 ? 0 : NO_SLOT;
+    count = 0;
+}
+
+Handle HandleTable::Add() {
+    if (firstFree == NO_SLOT) {
+        return Invalid();
+    }
+    unsigned int slot = firstFree;
+    firstFree = slots[slot].index;
+    slots[slot].index = (unsigned int)count;
+    indexToSlot[count] = slot;
+    count++;
+    Handle handle = {slot, slots[slot].generation};
+    return handle;
+}
+
+size_t HandleTable::Remove(Handle handle) {
+    if (!IsValid(handle)) {
+        return HANDLE_NO_INDEX;
+    }
+    return RemoveAt(slots[handle.slot].index);
+}
+
+size_t HandleTable::RemoveAt(size_t index) {
+    unsigned int slot = indexToSlot[index];
+
+    // the last item takes the freed index
+    size_t last = count - 1;
+    unsigned int lastSlot = indexToSlot[last];
+    indexToSlot[index] = lastSlot;
+    slots[lastSlot].index = (unsigned int)index;
+
+    slots[slot].generation++;
+    slots[slot].index = firstFree;
+    firstFree = slot;
+    count--;
+    return index;
+}
+
+bool HandleTable::IsValid(Handle handle) const {
+    if (handle.slot >= slots.size() || slots[handle.slot].generation != handle.generation) {
+        return false;
+    }
+    // a free slot with a matching generation can only come from an invalid handle
+    size_t index = slots[handle.slot].index;
+    return index < count && indexToSlot[index] == handle.slot;
+}
+
+size_t HandleTable::IndexOf(Handle handle) const {
+    return slots[handle.slot].index;
+}
+
+Handle HandleTable::HandleAt(size_t index) const {
+    unsigned int slot = indexToSlot[index];
+    Handle handle = {slot, slots[slot].generation};
+    return handle;
+}
+
+size_t HandleTable::Size() const {
+    return count;
+}
+
+size_t HandleTable::Capacity() const {
+    return slots.size();
+}
+
+bool HandleTable::Full() const {
+    return firstFree == NO_SLOT;
+}
+
+Handle HandleTable::Invalid() {
+    Handle handle = {NO_SLOT, 0};
+    return handle;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// what HandleTable::Remove returns for a handle that was already removed
+#define HANDLE_NO_INDEX ((size_t)-1)
+
+// Refers to an item in a HandleTable or Pool. The generation changes every time
+// a slot is reused, so a handle kept after its item was despawned is detected
+// instead of silently pointing at whatever was spawned into the slot next.
+struct Handle {
+    unsigned int slot;
+    unsigned int generation;
+};
+
+// Maps handles to dense indices for a fixed number of items. Items live packed
+// at indices 0 .. Size() - 1 in whatever arrays the owner keeps, so iterating
+// them touches no holes. Removing an item moves the last one into its place,
+// which the owner mirrors in its own arrays. Every operation is O(1) and
+// nothing allocates after Reset.
+class HandleTable {
+    public:
+
+        HandleTable();
+
+        void Reset(size_t capacity);
+
+        // handle for a new item at index Size(), or an invalid handle when full
+        Handle Add();
+        // frees the handle and returns the index it had, the item at the last index moves there.
+        // a handle that is no longer valid frees nothing and gives HANDLE_NO_INDEX
+        size_t Remove(Handle handle);
+        size_t RemoveAt(size_t index);
+
+        bool IsValid(Handle handle) const;
+        size_t IndexOf(Handle handle) const;
+        Handle HandleAt(size_t index) const;
+
+        size_t Size() const;
+        size_t Capacity() const;
+        bool Full() const;
+
+        static Handle Invalid();
+
+    private:
+
+        struct Slot {
+            unsigned int generation;
+            // index of the item while in use, next free slot otherwise
+            unsigned int index;
+        };
+
+        std::vector<Slot> slots;
+        std::vector<unsigned int> indexToSlot;
+        unsigned int firstFree;
+        size_t count;
+};
+
+// Fixed capacity storage for one type of spawned object, kept dense for iteration.
+//
+//     Pool<Entity> bullets(64);
+//     Handle bullet = bullets.Spawn(Entity(...));
+//     for (size_t i = 0; i < bullets.Size(); i++) { bullets[i]... }
+//     bullets.Despawn(bullet);
+template <typename T>
+class Pool {
+    public:
+
+        Pool(size_t capacity = 0) {
+            Reset(capacity);
+        }
+
+        void Reset(size_t capacity) {
+            table.Reset(capacity);
+            items.clear();
+            items.reserve(capacity);
+        }
+
+        // invalid handle when the pool is full, the item is not added then
+        Handle Spawn(const T &item) {
+            if (table.Full()) {
+                return HandleTable::Invalid();
+            }
+            items.push_back(item);
+            return table.Add();
+        }
+
+        bool Despawn(Handle handle) {
+            if (!table.IsValid(handle)) {
+                return false;
+            }
+            RemoveIndex(table.Remove(handle));
+            return true;
+        }
+
+        void DespawnAt(size_t index) {
+            RemoveIndex(table.RemoveAt(index));
+        }
+
+        void Clear() {
+            table.Reset(table.Capacity());
+            items.clear();
+        }
+
+        // NULL for a despawned item
+        T *Get(Handle handle) {
+            return table.IsValid(handle) ? &items[table.IndexOf(handle)] : NULL;
+        }
+
+        Handle HandleAt(size_t index) const {
+            return table.HandleAt(index);
+        }
+
+        T &operator[](size_t index) {
+            return items[index];
+        }
+
+        const T &operator[](size_t index) const {
+            return items[index];
+        }
+
+        T *Data() {
+            return items.empty() ? NULL : &items[0];
+        }
+
+        size_t Size() const {
+            return items.size();
+        }
+
+        bool Full() const {
+            return table.Full();
+        }
+
+    private:
+
+        void RemoveIndex(size_t index) {
+            if (index != items.size() - 1) {
+                items[index] = items.back();
+            }
+            items.pop_back();
+        }
+
+        HandleTable table;
+        std::vector<T> items;
+};
@@ -0,0 +1,164 @@
+#include "Headless.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+
+HeadlessContext::HeadlessContext(): width(0), height(0), framebuffer(0), colorRenderbuffer(0), context(NULL) {
+#ifdef HEADLESS_EGL
+    display = EGL_NO_DISPLAY;
+#else
+    window = NULL;
+#endif
+}
+
+bool HeadlessContext::Create(int width, int height) {
+    this->width = width;
+    this->height = height;
+    
+#ifdef HEADLESS_EGL
+    // prefer the surfaceless platform so no X11 or GBM device is needed
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay != NULL) {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    }
+    if (display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL)) {
+        std::cout << "Unable to initialize EGL" << std::endl;
+        return false;
+    }
+    eglBindAPI(EGL_OPENGL_API);
+    
+    EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+        std::cout << "No EGL config for desktop OpenGL" << std::endl;
+        return false;
+    }
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, NULL);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        std::cout << "Unable to create a surfaceless EGL context" << std::endl;
+        return false;
+    }
+#else
+    window = SDL_CreateWindow("Headless", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+    if (window == NULL) {
+        std::cout << "Unable to create a hidden window" << std::endl;
+        return false;
+    }
+    context = SDL_GL_CreateContext(window);
+    SDL_GL_MakeCurrent(window, context);
+#endif
+    
+    #ifdef _WINDOWS
+    glewInit();
+    #endif
+    
+    glGenRenderbuffers(1, &colorRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRenderbuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "Offscreen framebuffer is incomplete" << std::endl;
+        return false;
+    }
+    
+    glViewport(0, 0, width, height);
+    std::cout << "Headless renderer: " << glGetString(GL_RENDERER) << std::endl;
+    return true;
+}
+
+void HeadlessContext::EndFrame() {
+    glFinish();
+}
+
+void HeadlessContext::Destroy() {
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &colorRenderbuffer);
+    framebuffer = colorRenderbuffer = 0;
+#ifdef HEADLESS_EGL
+    if (display != EGL_NO_DISPLAY) {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, context);
+        eglTerminate(display);
+        display = EGL_NO_DISPLAY;
+    }
+#else
+    if (window != NULL) {
+        SDL_GL_DeleteContext(context);
+        SDL_DestroyWindow(window);
+        window = NULL;
+    }
+#endif
+}
+
+bool HasFlag(int argc, char *argv[], const char *flag) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], flag) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IsHeadless(int argc, char *argv[]) {
+    if (HasFlag(argc, argv, "--headless")) {
+        return true;
+    }
+    const char *env = getenv("HEADLESS");
+    return env != NULL && strcmp(env, "0") != 0;
+}
+
+int HeadlessFrameCount(int argc, char *argv[], int defaultFrames) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0) {
+            return atoi(argv[i + 1]);
+        }
+    }
+    const char *env = getenv("HEADLESS_FRAMES");
+    return env != NULL ? atoi(env) : defaultFrames;
+}
+
+void FrameTimes::Reserve(size_t frames) {
+    milliseconds.reserve(frames);
+}
+
+void FrameTimes::BeginFrame() {
+    frameStart = SDL_GetPerformanceCounter();
+}
+
+void FrameTimes::EndFrame() {
+    Uint64 ticks = SDL_GetPerformanceCounter() - frameStart;
+    milliseconds.push_back((float)((double)ticks * 1000.0 / (double)SDL_GetPerformanceFrequency()));
+}
+
+void FrameTimes::Report(const char *name) {
+    if (milliseconds.empty()) {
+        return;
+    }
+    std::vector<float> sorted = milliseconds;
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (size_t i = 0; i < sorted.size(); i++) {
+        total += sorted[i];
+    }
+    size_t last = sorted.size() - 1;
+    std::cout << name << ": " << sorted.size() << " frames"
+              << " mean " << total / sorted.size() << " ms"
+              << " min " << sorted[0]
+              << " p50 " << sorted[last / 2]
+              << " p95 " << sorted[last * 95 / 100]
+              << " p99 " << sorted[last * 99 / 100]
+              << " max " << sorted[last] << std::endl;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL.h>
+#include <SDL_opengl.h>
+#include <vector>
+#include <cstddef>
+#ifdef HEADLESS_EGL
+	#include <EGL/egl.h>
+	#include <EGL/eglext.h>
+#endif
+
+// Offscreen rendering target for running a game loop without a visible window.
+// Built with HEADLESS_EGL it creates a surfaceless EGL context, which Mesa's
+// llvmpipe provides on machines without a GPU or display server. Otherwise it
+// falls back to a hidden SDL window. Either way frames render into a framebuffer
+// object instead of a window back buffer.
+class HeadlessContext {
+    public:
+    
+        HeadlessContext();
+    
+        bool Create(int width, int height);
+        // stands in for SDL_GL_SwapWindow, waits for the frame to finish rendering
+        void EndFrame();
+        void Destroy();
+    
+        int width;
+        int height;
+        GLuint framebuffer;
+        GLuint colorRenderbuffer;
+    
+    #ifdef HEADLESS_EGL
+        EGLDisplay display;
+        EGLContext context;
+    #else
+        SDL_Window *window;
+        SDL_GLContext context;
+    #endif
+};
+
+// true if flag is anywhere on the command line
+bool HasFlag(int argc, char *argv[], const char *flag);
+
+// --headless on the command line or HEADLESS=1 in the environment
+bool IsHeadless(int argc, char *argv[]);
+
+// --frames N on the command line or HEADLESS_FRAMES=N in the environment
+int HeadlessFrameCount(int argc, char *argv[], int defaultFrames);
+
+// Collects per-frame wall times and prints a summary at the end of a run.
+class FrameTimes {
+    public:
+    
+        void Reserve(size_t frames);
+        void BeginFrame();
+        void EndFrame();
+        void Report(const char *name);
+    
+        std::vector<float> milliseconds;
+    
+    private:
+    
+        Uint64 frameStart;
+};
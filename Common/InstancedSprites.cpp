@@ -0,0 +1,82 @@
+#include "InstancedSprites.h"
+#include <cstddef>
+
+InstancedSprites::InstancedSprites(): quadBuffer(0), instanceBuffer(0), maxInstances(0) {}
+
+void InstancedSprites::Load(const char *vertexShaderFile, const char *fragmentShaderFile, size_t maxInstances) {
+    program.Load(vertexShaderFile, fragmentShaderFile);
+    instanceTransformAttribute = glGetAttribLocation(program.programID, "instanceTransform");
+    instanceRotationAttribute = glGetAttribLocation(program.programID, "instanceRotation");
+    instanceUVAttribute = glGetAttribLocation(program.programID, "instanceUV");
+    
+    this->maxInstances = maxInstances;
+    instanceData.reserve(maxInstances);
+    
+    // unit quad shared by every instance, same layout as Entity::Draw
+    float quad[] = {
+        -0.5f, -0.5f, 0.0f, 1.0f,
+        0.5f, -0.5f, 1.0f, 1.0f,
+        0.5f, 0.5f, 1.0f, 0.0f,
+        -0.5f, -0.5f, 0.0f, 1.0f,
+        0.5f, 0.5f, 1.0f, 0.0f,
+        -0.5f, 0.5f, 0.0f, 0.0f
+    };
+    glGenBuffers(1, &quadBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    
+    glGenBuffers(1, &instanceBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, maxInstances * sizeof(SpriteInstance), NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstancedSprites::Cleanup() {
+    glDeleteBuffers(1, &quadBuffer);
+    glDeleteBuffers(1, &instanceBuffer);
+    quadBuffer = instanceBuffer = 0;
+    program.Cleanup();
+}
+
+void InstancedSprites::Draw(GLuint texture, const SpriteInstance *instances, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    
+    program.Use();
+    glBindTexture(GL_TEXTURE_2D, texture);
+    
+    glBindBuffer(GL_ARRAY_BUFFER, quadBuffer);
+    glVertexAttribPointer(program.positionAttribute, 2, GL_FLOAT, false, 4 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(program.positionAttribute);
+    glVertexAttribPointer(program.texCoordAttribute, 2, GL_FLOAT, false, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(program.texCoordAttribute);
+    
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    GLsizei stride = sizeof(SpriteInstance);
+    glVertexAttribPointer(instanceTransformAttribute, 4, GL_FLOAT, false, stride, (void*)offsetof(SpriteInstance, x));
+    glVertexAttribPointer(instanceRotationAttribute, 1, GL_FLOAT, false, stride, (void*)offsetof(SpriteInstance, rotation));
+    glVertexAttribPointer(instanceUVAttribute, 4, GL_FLOAT, false, stride, (void*)offsetof(SpriteInstance, u));
+    GLint instanceAttributes[] = {instanceTransformAttribute, instanceRotationAttribute, instanceUVAttribute};
+    for (GLint attribute: instanceAttributes) {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);
+    }
+    
+    // upload and draw in slices of at most maxInstances
+    for (size_t first = 0; first < count; first += maxInstances) {
+        size_t batch = count - first < maxInstances ? count - first : maxInstances;
+        glBufferData(GL_ARRAY_BUFFER, maxInstances * sizeof(SpriteInstance), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, batch * sizeof(SpriteInstance), instances + first);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei)batch);
+    }
+    
+    // attribute slots are shared with the other programs, so put the divisors back
+    for (GLint attribute: instanceAttributes) {
+        glVertexAttribDivisor(attribute, 0);
+        glDisableVertexAttribArray(attribute);
+    }
+    glDisableVertexAttribArray(program.positionAttribute);
+    glDisableVertexAttribArray(program.texCoordAttribute);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+#include <vector>
+#include "ShaderProgram.h"
+
+// the legacy macOS context only exposes instancing through the ARB extensions
+#ifdef __APPLE__
+	#define glVertexAttribDivisor glVertexAttribDivisorARB
+	#define glDrawArraysInstanced glDrawArraysInstancedARB
+#endif
+
+// Per-instance attributes read by vertex_instanced.glsl.
+struct SpriteInstance {
+    float x, y;
+    float scaleX, scaleY;
+    float rotation;
+    float u, v, width, height;
+};
+
+// Draws many copies of a unit quad in one instanced call, placing each one from
+// the instance buffer instead of a modelMatrix upload.
+class InstancedSprites {
+    public:
+    
+        InstancedSprites();
+    
+        void Load(const char *vertexShaderFile, const char *fragmentShaderFile, size_t maxInstances = 1024);
+        void Cleanup();
+    
+        void Draw(GLuint texture, const SpriteInstance *instances, size_t count);
+    
+        // fills the instance buffer from any array of entities with toInstance(entity)
+        template <typename T, typename F>
+        void Draw(GLuint texture, const T *entities, size_t count, F toInstance) {
+            instanceData.clear();
+            for (size_t i = 0; i < count; i++) {
+                instanceData.push_back(toInstance(entities[i]));
+            }
+            Draw(texture, instanceData.data(), instanceData.size());
+        }
+    
+        ShaderProgram program;
+    
+        GLuint quadBuffer;
+        GLuint instanceBuffer;
+        size_t maxInstances;
+    
+        GLint instanceTransformAttribute;
+        GLint instanceRotationAttribute;
+        GLint instanceUVAttribute;
+    
+    private:
+    
+        std::vector<SpriteInstance> instanceData;
+};
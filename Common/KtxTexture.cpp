@@ -0,0 +1,131 @@
+#include "KtxTexture.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+const unsigned char KTX_IDENTIFIER[KTX_IDENTIFIER_LENGTH] = {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+// header fields after the identifier, in file order
+enum KtxField {
+    KTX_FIELD_ENDIANNESS, KTX_FIELD_GL_TYPE, KTX_FIELD_GL_TYPE_SIZE, KTX_FIELD_GL_FORMAT,
+    KTX_FIELD_GL_INTERNAL_FORMAT, KTX_FIELD_GL_BASE_INTERNAL_FORMAT, KTX_FIELD_WIDTH, KTX_FIELD_HEIGHT,
+    KTX_FIELD_DEPTH, KTX_FIELD_ARRAY_ELEMENTS, KTX_FIELD_FACES, KTX_FIELD_MIPMAP_LEVELS, KTX_FIELD_KEY_VALUE_BYTES
+};
+
+static unsigned int ReadU32(const unsigned char *bytes) {
+    return (unsigned int)bytes[0] | (unsigned int)bytes[1] << 8 | (unsigned int)bytes[2] << 16 | (unsigned int)bytes[3] << 24;
+}
+
+static unsigned int HeaderField(const std::vector<unsigned char> &data, KtxField field) {
+    return ReadU32(&data[KTX_IDENTIFIER_LENGTH + field * 4]);
+}
+
+KtxTexture::KtxTexture(): width(0), height(0), levelCount(0) {}
+
+bool KtxTexture::Load(const char *path) {
+    Free();
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        std::cout << "Unable to open texture " << path << std::endl;
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size > 0) {
+        data.resize((size_t)size);
+        size = (long)fread(&data[0], 1, data.size(), file);
+    }
+    fclose(file);
+    if (size < KTX_HEADER_LENGTH || (size_t)size != data.size() || memcmp(&data[0], KTX_IDENTIFIER, KTX_IDENTIFIER_LENGTH) != 0) {
+        std::cout << path << " is not a KTX texture" << std::endl;
+        Free();
+        return false;
+    }
+
+    // TextureCooker only writes plain RGBA8 2D textures, anything else is not worth a code path here
+    if (HeaderField(data, KTX_FIELD_ENDIANNESS) != KTX_ENDIANNESS ||
+        HeaderField(data, KTX_FIELD_GL_TYPE) != GL_UNSIGNED_BYTE ||
+        HeaderField(data, KTX_FIELD_GL_FORMAT) != GL_RGBA ||
+        HeaderField(data, KTX_FIELD_GL_INTERNAL_FORMAT) != GL_RGBA8 ||
+        HeaderField(data, KTX_FIELD_DEPTH) != 0 ||
+        HeaderField(data, KTX_FIELD_ARRAY_ELEMENTS) != 0 ||
+        HeaderField(data, KTX_FIELD_FACES) != 1) {
+        std::cout << "Texture " << path << " is not a little-endian RGBA8 2D KTX file" << std::endl;
+        Free();
+        return false;
+    }
+    width = (int)HeaderField(data, KTX_FIELD_WIDTH);
+    height = (int)HeaderField(data, KTX_FIELD_HEIGHT);
+    // read unsigned so a huge count cannot turn negative and slip past the limit
+    unsigned int levels = HeaderField(data, KTX_FIELD_MIPMAP_LEVELS);
+    // zero asks the loader to generate the chain, which is the same as no mipmaps here
+    if (levels == 0) {
+        levels = 1;
+    }
+    if (width <= 0 || height <= 0 || levels > KTX_MAX_LEVELS) {
+        std::cout << "Texture " << path << " has a bad size or level count" << std::endl;
+        Free();
+        return false;
+    }
+    levelCount = (int)levels;
+
+    size_t offset = KTX_HEADER_LENGTH + (size_t)HeaderField(data, KTX_FIELD_KEY_VALUE_BYTES);
+    for (int level = 0; level < levelCount; level++) {
+        size_t levelWidth = (size_t)(width >> level > 0 ? width >> level : 1);
+        size_t levelHeight = (size_t)(height >> level > 0 ? height >> level : 1);
+        size_t expected = levelWidth * levelHeight * 4;
+        if (offset + 4 > data.size() || ReadU32(&data[offset]) != expected || offset + 4 + expected > data.size()) {
+            std::cout << "Texture " << path << " is truncated at mip level " << level << std::endl;
+            Free();
+            return false;
+        }
+        levelOffsets[level] = offset + 4;
+        levelSizes[level] = expected;
+        // RGBA rows are already a multiple of 4 bytes, so there is never any mip padding
+        offset += 4 + expected;
+    }
+    return true;
+}
+
+GLuint KtxTexture::Upload(GLint filter) const {
+    if (levelCount == 0) {
+        return 0;
+    }
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    for (int level = 0; level < levelCount; level++) {
+        int levelWidth = width >> level > 0 ? width >> level : 1;
+        int levelHeight = height >> level > 0 ? height >> level : 1;
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, levelWidth, levelHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, &data[levelOffsets[level]]);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+    GLint minFilter = filter;
+    if (levelCount > 1) {
+        minFilter = filter == GL_NEAREST ? GL_NEAREST_MIPMAP_NEAREST : GL_LINEAR_MIPMAP_LINEAR;
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    return texture;
+}
+
+void KtxTexture::Free() {
+    // swap frees the memory, clear would keep it
+    std::vector<unsigned char>().swap(data);
+    width = height = 0;
+    levelCount = 0;
+}
+
+size_t KtxTexture::Bytes() const {
+    size_t bytes = 0;
+    for (int level = 0; level < levelCount; level++) {
+        bytes += levelSizes[level];
+    }
+    return bytes;
+}
+
+bool IsKtxPath(const char *path) {
+    size_t length = strlen(path);
+    return length >= 4 && strcmp(path + length - 4, ".ktx") == 0;
+}
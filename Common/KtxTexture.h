@@ -0,0 +1,47 @@
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+#include <vector>
+#include <cstddef>
+
+// KTX 1.1 layout written by TextureCooker and read by KtxTexture
+#define KTX_IDENTIFIER_LENGTH 12
+#define KTX_HEADER_LENGTH 64
+#define KTX_ENDIANNESS 0x04030201
+#define KTX_MAX_LEVELS 16
+
+extern const unsigned char KTX_IDENTIFIER[KTX_IDENTIFIER_LENGTH];
+
+// A texture cooked by TextureCooker: RGBA8 pixels for every mip level, ready
+// to hand to glTexImage2D. Load reads the whole file in one go and only
+// checks the header, nothing is decoded, so it is cheap enough to do on a
+// loading thread. Upload has to run on the GL thread.
+class KtxTexture {
+    public:
+
+        KtxTexture();
+
+        bool Load(const char *path);
+        // creates the texture with every level, a mipmapped min filter is picked to match filter
+        GLuint Upload(GLint filter) const;
+        void Free();
+
+        // GPU memory of all levels together
+        size_t Bytes() const;
+
+        int width;
+        int height;
+        int levelCount;
+
+    private:
+
+        std::vector<unsigned char> data;
+        size_t levelOffsets[KTX_MAX_LEVELS];
+        size_t levelSizes[KTX_MAX_LEVELS];
+};
+
+// true for paths ending in .ktx
+bool IsKtxPath(const char *path);
@@ -0,0 +1,44 @@
+#include "LevelMap.h"
+#include <iostream>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+LevelMap::LevelMap(): mapWidth(0), mapHeight(0), tileWidth(0), tileHeight(0), mapData(NULL), fromCompiled(false) {}
+
+// true only when both files exist and path was modified before source
+static bool IsOlder(const char *path, const char *source) {
+    struct stat pathInfo, sourceInfo;
+    if (stat(path, &pathInfo) != 0 || stat(source, &sourceInfo) != 0) {
+        return false;
+    }
+    return pathInfo.st_mtime < sourceInfo.st_mtime;
+}
+
+bool LevelMap::Load(const char *compiledPath, const char *textPath) {
+    fromCompiled = false;
+    if (IsOlder(compiledPath, textPath)) {
+        std::cout << compiledPath << " is older than " << textPath << ", rerun MapCompiler. Reading the text instead" << std::endl;
+    } else if (compiled.Load(compiledPath) && compiled.mapData != NULL) {
+        fromCompiled = true;
+        mapWidth = compiled.mapWidth;
+        mapHeight = compiled.mapHeight;
+        tileWidth = compiled.tileWidth;
+        tileHeight = compiled.tileHeight;
+        mapData = compiled.mapData;
+        return true;
+    }
+
+    if (!parser.Load(textPath)) {
+        return false;
+    }
+    if (parser.mapData == NULL) {
+        std::cout << textPath << " has no tile layer" << std::endl;
+        return false;
+    }
+    mapWidth = parser.mapWidth;
+    mapHeight = parser.mapHeight;
+    tileWidth = parser.tileWidth;
+    tileHeight = parser.tileHeight;
+    mapData = parser.mapData;
+    return true;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "CompiledMap.h"
+#include "FlareMapParser.h"
+
+// A level read from the .map file MapCompiler writes, or parsed from the Tiled
+// text it is compiled from when the .map is missing, does not validate or is
+// older than the text. The .map is a build output, so a fresh checkout only has
+// the text until MapCompiler has been run. Either way mapData has FlareMap's
+// [y][x] shape and values.
+class LevelMap {
+    public:
+
+        LevelMap();
+
+        // false if neither file could be read
+        bool Load(const char *compiledPath, const char *textPath);
+
+        int mapWidth;
+        int mapHeight;
+        int tileWidth;
+        int tileHeight;
+        // rows of the first layer
+        const unsigned int *const *mapData;
+
+        // whether the level came from the .map rather than the text
+        bool fromCompiled;
+
+    private:
+
+        CompiledMap compiled;
+        FlareMapParser parser;
+};
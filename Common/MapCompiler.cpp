@@ -0,0 +1,167 @@
+// Offline tile map compiler.
+//
+// Turns a Tiled text export ([header], [tilesets] and [layer] sections with
+// comma separated data= rows, the files FlareMap reads) into the binary
+// layout in CompiledMap.h, reading the text with FlareMapParser. The game
+// maps the result and uses the tiles in place instead of parsing text on
+// every launch. After writing, the output is loaded back and compared
+// against the text, and both load times are printed.
+//
+//   g++ -O2 -std=c++11 MapCompiler.cpp FlareMapParser.cpp CompiledMap.cpp MappedFile.cpp -o MapCompiler
+//   ./MapCompiler <TileMap.txt> <output.map>
+
+#include "CompiledMap.h"
+#include "FlareMapParser.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+
+static double Milliseconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void CopyName(char *name, const std::string &value, const char *what) {
+    if (value.size() >= COMPILED_MAP_NAME_LENGTH) {
+        std::cout << what << " name " << value << " is cut to " << COMPILED_MAP_NAME_LENGTH - 1 << " characters" << std::endl;
+    }
+    memset(name, 0, COMPILED_MAP_NAME_LENGTH);
+    strncpy(name, value.c_str(), COMPILED_MAP_NAME_LENGTH - 1);
+}
+
+static void WriteU32(std::ofstream &file, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        file.put((char)((value >> (i * 8)) & 0xFF));
+    }
+}
+
+static bool WriteCompiledMap(const char *path, const FlareMapParser &map) {
+    uint64_t tilesetOffset = sizeof(CompiledMapHeader);
+    uint64_t layerOffset = tilesetOffset + map.tilesets.size() * sizeof(CompiledTileset);
+    uint64_t dataOffset = layerOffset + map.layers.size() * sizeof(CompiledLayer);
+    uint64_t layerSize = (uint64_t)map.mapWidth * map.mapHeight * sizeof(uint32_t);
+    if (dataOffset + map.layers.size() * layerSize > 0xFFFFFFFFull) {
+        std::cout << "Map is too large for 32-bit offsets" << std::endl;
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (file.fail()) {
+        std::cout << "Unable to write " << path << std::endl;
+        return false;
+    }
+    file.write(COMPILED_MAP_MAGIC, 4);
+    WriteU32(file, COMPILED_MAP_VERSION);
+    WriteU32(file, (uint32_t)map.mapWidth);
+    WriteU32(file, (uint32_t)map.mapHeight);
+    WriteU32(file, (uint32_t)map.tileWidth);
+    WriteU32(file, (uint32_t)map.tileHeight);
+    WriteU32(file, (uint32_t)map.tilesets.size());
+    WriteU32(file, (uint32_t)map.layers.size());
+    WriteU32(file, (uint32_t)tilesetOffset);
+    WriteU32(file, (uint32_t)layerOffset);
+
+    for (size_t i = 0; i < map.tilesets.size(); i++) {
+        const FlareMapTileset &tileset = map.tilesets[i];
+        char image[COMPILED_MAP_NAME_LENGTH];
+        CopyName(image, tileset.image, "Tileset");
+        file.write(image, COMPILED_MAP_NAME_LENGTH);
+        WriteU32(file, (uint32_t)tileset.tileWidth);
+        WriteU32(file, (uint32_t)tileset.tileHeight);
+        WriteU32(file, (uint32_t)tileset.offsetX);
+        WriteU32(file, (uint32_t)tileset.offsetY);
+    }
+    for (size_t i = 0; i < map.layers.size(); i++) {
+        char name[COMPILED_MAP_NAME_LENGTH];
+        CopyName(name, map.layers[i].name, "Layer");
+        file.write(name, COMPILED_MAP_NAME_LENGTH);
+        WriteU32(file, (uint32_t)(dataOffset + i * layerSize));
+        WriteU32(file, 0);
+    }
+
+    // tile arrays in 64 KB blocks, byte by byte through put() would dominate large maps
+    std::vector<unsigned char> block;
+    for (size_t i = 0; i < map.layers.size(); i++) {
+        const std::vector<unsigned int> &tiles = map.layers[i].tiles;
+        for (size_t start = 0; start < tiles.size(); start += 16384) {
+            size_t end = std::min(tiles.size(), start + 16384);
+            block.resize((end - start) * 4);
+            for (size_t t = start; t < end; t++) {
+                for (int b = 0; b < 4; b++) {
+                    block[(t - start) * 4 + b] = (unsigned char)((tiles[t] >> (b * 8)) & 0xFF);
+                }
+            }
+            file.write((const char *)block.data(), block.size());
+        }
+    }
+    return !file.fail();
+}
+
+// keeps the timed pass over the tiles from being optimized away
+static volatile unsigned long long tileSum;
+
+// loads the output back and checks every tile against the text
+static bool VerifyCompiledMap(const char *path, const FlareMapParser &map, double &loadTime, double &touchTime) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    CompiledMap compiled;
+    if (!compiled.Load(path)) {
+        return false;
+    }
+    loadTime = Milliseconds(start);
+
+    // reading every tile once is what pays for the page faults
+    start = std::chrono::steady_clock::now();
+    unsigned long long sum = 0;
+    for (int y = 0; y < compiled.mapHeight; y++) {
+        for (int x = 0; x < compiled.mapWidth; x++) {
+            sum += compiled.mapData[y][x];
+        }
+    }
+    touchTime = Milliseconds(start);
+    tileSum = sum;
+
+    if (compiled.mapWidth != map.mapWidth || compiled.mapHeight != map.mapHeight ||
+        compiled.layerCount != (int)map.layers.size() || compiled.tilesetCount != (int)map.tilesets.size()) {
+        std::cout << "Compiled map does not match the text header" << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < map.layers.size(); i++) {
+        const std::vector<unsigned int> &tiles = map.layers[i].tiles;
+        if (memcmp(compiled.LayerData((int)i), tiles.data(), tiles.size() * sizeof(uint32_t)) != 0) {
+            std::cout << "Compiled layer " << map.layers[i].name << " does not match the text" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        std::cout << "usage: " << argv[0] << " <TileMap.txt> <output.map>" << std::endl;
+        return 1;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    FlareMapParser map;
+    if (!map.Load(argv[1])) {
+        return 1;
+    }
+    double parseTime = Milliseconds(start);
+
+    if (!WriteCompiledMap(argv[2], map)) {
+        return 1;
+    }
+    double loadTime, touchTime;
+    if (!VerifyCompiledMap(argv[2], map, loadTime, touchTime)) {
+        return 1;
+    }
+
+    printf("%s: %d x %d tiles, %d layers, %d tilesets\n", argv[2], map.mapWidth, map.mapHeight, (int)map.layers.size(), (int)map.tilesets.size());
+    printf("text parse %.2f ms, mapped load %.3f ms, first pass over the tiles %.2f ms\n", parseTime, loadTime, touchTime);
+    return 0;
+}
@@ -0,0 +1,39 @@
+// Writes synthetic Tiled text levels of any size, for trying MapCompiler and
+// FlareMapParser on maps far larger than the homework levels.
+//
+//   g++ -O2 -std=c++11 MapGenerator.cpp FlareMapParser.cpp MappedFile.cpp -o MapGenerator
+//   ./MapGenerator <width> <height> <output.txt> [layers] [seed]
+
+#include "FlareMapParser.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+int main(int argc, char *argv[]) {
+    if (argc < 4) {
+        fprintf(stderr, "usage: %s <width> <height> <output.txt> [layers] [seed]\n", argv[0]);
+        return 1;
+    }
+    int width = atoi(argv[1]);
+    int height = atoi(argv[2]);
+    int layerCount = argc > 4 ? atoi(argv[4]) : 1;
+    unsigned int seed = argc > 5 ? (unsigned int)strtoul(argv[5], NULL, 10) : 1;
+    if (width <= 0 || height <= 0 || layerCount <= 0) {
+        fprintf(stderr, "width, height and layers have to be positive\n");
+        return 1;
+    }
+
+    std::string text;
+    GenerateFlareMapText(width, height, layerCount, seed, text);
+    FILE *file = fopen(argv[3], "wb");
+    if (file == NULL || fwrite(text.data(), 1, text.size(), file) != text.size()) {
+        fprintf(stderr, "Unable to write %s\n", argv[3]);
+        if (file != NULL) {
+            fclose(file);
+        }
+        return 1;
+    }
+    fclose(file);
+    printf("%s: %d x %d tiles, %d layers, %.1f MB\n", argv[3], width, height, layerCount, text.size() / 1e6);
+    return 0;
+}
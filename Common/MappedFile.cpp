@@ -0,0 +1,99 @@
+#include "MappedFile.h"
+#include <iostream>
+#ifdef _WINDOWS
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+#ifdef _WINDOWS
+
+MappedFile::MappedFile(): data(NULL), size(0), file(INVALID_HANDLE_VALUE), mapping(NULL) {}
+
+bool MappedFile::Open(const char *path) {
+    Close();
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cout << "Unable to open " << path << std::endl;
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        std::cout << path << " is empty" << std::endl;
+        Close();
+        return false;
+    }
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping != NULL) {
+        data = (const unsigned char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+    if (data == NULL) {
+        std::cout << "Unable to map " << path << std::endl;
+        Close();
+        return false;
+    }
+    size = (size_t)fileSize.QuadPart;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data != NULL) {
+        UnmapViewOfFile(data);
+    }
+    if (mapping != NULL) {
+        CloseHandle(mapping);
+    }
+    if (file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+    }
+    data = NULL;
+    size = 0;
+    file = INVALID_HANDLE_VALUE;
+    mapping = NULL;
+}
+
+#else
+
+MappedFile::MappedFile(): data(NULL), size(0) {}
+
+bool MappedFile::Open(const char *path) {
+    Close();
+    int descriptor = open(path, O_RDONLY);
+    if (descriptor < 0) {
+        std::cout << "Unable to open " << path << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(descriptor, &info) != 0 || info.st_size == 0) {
+        std::cout << path << " is empty" << std::endl;
+        close(descriptor);
+        return false;
+    }
+    // the mapping keeps its own reference to the file, the descriptor is not needed past here
+    void *mapped = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (mapped == MAP_FAILED) {
+        std::cout << "Unable to map " << path << std::endl;
+        return false;
+    }
+    data = (const unsigned char *)mapped;
+    size = (size_t)info.st_size;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data != NULL) {
+        munmap((void *)data, size);
+    }
+    data = NULL;
+    size = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    Close();
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+
+// A whole file mapped read-only into memory. Pages are read from disk the
+// first time they are touched, so opening a large file costs about as much
+// as opening a small one. The mapping stays valid until Close or destruction.
+class MappedFile {
+    public:
+
+        MappedFile();
+        ~MappedFile();
+
+        bool Open(const char *path);
+        void Close();
+
+        const unsigned char *data;
+        size_t size;
+
+    private:
+
+        // unmapping twice would be bad, so there is only ever one owner
+        MappedFile(const MappedFile &);
+        MappedFile &operator=(const MappedFile &);
+
+    #ifdef _WINDOWS
+        void *file;
+        void *mapping;
+    #endif
+};
@@ -1,6 +1,12 @@
 
 #include "ShaderProgram.h"
 
+GLuint ShaderProgram::boundProgram = 0;
+int ShaderProgram::issuedCalls = 0;
+int ShaderProgram::avoidedCalls = 0;
+
+ShaderProgram::ShaderProgram(): programID(0), modelMatrixSet(false), projectionMatrixSet(false), viewMatrixSet(false), colorSet(false) {}
+
 void ShaderProgram::Load(const char *vertexShaderFile, const char *fragmentShaderFile) {
     
     // create the vertex shader
@@ -27,12 +33,20 @@ void ShaderProgram::Load(const char *vertexShaderFile, const char *fragmentShade
     
     positionAttribute = glGetAttribLocation(programID, "position");
     texCoordAttribute = glGetAttribLocation(programID, "texCoord");
+    
+    modelMatrixSet = false;
+    projectionMatrixSet = false;
+    viewMatrixSet = false;
+    colorSet = false;
 	
 	SetColor(1.0f, 1.0f, 1.0f, 1.0f);
     
 }
 
 void ShaderProgram::Cleanup() {
+    if (boundProgram == programID) {
+        boundProgram = 0;
+    }
     glDeleteProgram(programID);
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
@@ -83,22 +97,66 @@ GLuint ShaderProgram::LoadShaderFromString(const std::string &shaderContents, GL
     return shaderID;
 }
 
+void ShaderProgram::Use() {
+    if (boundProgram == programID) {
+        avoidedCalls++;
+        return;
+    }
+    glUseProgram(programID);
+    boundProgram = programID;
+    issuedCalls++;
+}
+
+void ShaderProgram::ResetStats() {
+    issuedCalls = 0;
+    avoidedCalls = 0;
+}
+
 void ShaderProgram::SetColor(float r, float g, float b, float a) {
-	glUseProgram(programID);
+	Use();
+	glm::vec4 newColor(r, g, b, a);
+	if (colorSet && newColor == color) {
+		avoidedCalls++;
+		return;
+	}
 	glUniform4f(colorUniform, r, g, b, a);
+	color = newColor;
+	colorSet = true;
+	issuedCalls++;
 }
 
 void ShaderProgram::SetViewMatrix(const glm::mat4 &matrix) {
-    glUseProgram(programID);
+    Use();
+    if (viewMatrixSet && matrix == viewMatrix) {
+        avoidedCalls++;
+        return;
+    }
     glUniformMatrix4fv(viewMatrixUniform, 1, GL_FALSE, &matrix[0][0]);
+    viewMatrix = matrix;
+    viewMatrixSet = true;
+    issuedCalls++;
 }
 
 void ShaderProgram::SetModelMatrix(const glm::mat4 &matrix) {
-    glUseProgram(programID);
+    Use();
+    if (modelMatrixSet && matrix == modelMatrix) {
+        avoidedCalls++;
+        return;
+    }
     glUniformMatrix4fv(modelMatrixUniform, 1, GL_FALSE, &matrix[0][0]);
+    modelMatrix = matrix;
+    modelMatrixSet = true;
+    issuedCalls++;
 }
 
 void ShaderProgram::SetProjectionMatrix(const glm::mat4 &matrix) {
-    glUseProgram(programID);
-    glUniformMatrix4fv(projectionMatrixUniform, 1, GL_FALSE, &matrix[0][0]);    
+    Use();
+    if (projectionMatrixSet && matrix == projectionMatrix) {
+        avoidedCalls++;
+        return;
+    }
+    glUniformMatrix4fv(projectionMatrixUniform, 1, GL_FALSE, &matrix[0][0]);
+    projectionMatrix = matrix;
+    projectionMatrixSet = true;
+    issuedCalls++;
 }
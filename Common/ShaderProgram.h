@@ -9,12 +9,18 @@
 #include <fstream>
 #include <sstream>
 #include "glm/mat4x4.hpp"
+#include "glm/vec4.hpp"
 
 class ShaderProgram {
     public:
 	
+		ShaderProgram();
+	
 		void Load(const char *vertexShaderFile, const char *fragmentShaderFile);
 		void Cleanup();
+	
+        // binds the program unless it is already the current one
+        void Use();
 
 		void SetModelMatrix(const glm::mat4 &matrix);
         void SetProjectionMatrix(const glm::mat4 &matrix);
@@ -37,4 +43,22 @@ class ShaderProgram {
     
         GLuint vertexShader;
         GLuint fragmentShader;
+    
+        // last values uploaded to this program, so unchanged uniforms are skipped
+        glm::mat4 modelMatrix;
+        glm::mat4 projectionMatrix;
+        glm::mat4 viewMatrix;
+        glm::vec4 color;
+        bool modelMatrixSet;
+        bool projectionMatrixSet;
+        bool viewMatrixSet;
+        bool colorSet;
+    
+        // program bound through Use(); raw glUseProgram calls bypass this
+        static GLuint boundProgram;
+    
+        // glUseProgram/glUniform calls issued and skipped across all programs since ResetStats()
+        static int issuedCalls;
+        static int avoidedCalls;
+        static void ResetStats();
 };
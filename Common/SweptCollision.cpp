@@ -0,0 +1,66 @@
+#include "SweptCollision.h"
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+// entry and exit times of a point moving by distance along one axis through the slab [low, high]
+static bool SlabTimes(float start, float distance, float low, float high, float &entry, float &exit) {
+    if (distance == 0.0f) {
+        if (start <= low || start >= high) {
+            return false;
+        }
+        entry = -std::numeric_limits<float>::infinity();
+        exit = std::numeric_limits<float>::infinity();
+        return true;
+    }
+    float first = (low - start) / distance;
+    float second = (high - start) / distance;
+    entry = std::min(first, second);
+    exit = std::max(first, second);
+    return true;
+}
+
+bool SweepBoxes(const MovingBox &a, const MovingBox &b, float elapsed, Impact &impact) {
+    impact.time = 0.0f;
+    impact.normalX = 0.0f;
+    impact.normalY = 0.0f;
+
+    // move a relative to b and shrink a to a point by growing b by a's size
+    float halfWidth = (a.width + b.width) / 2.0f;
+    float halfHeight = (a.height + b.height) / 2.0f;
+    float offsetX = a.x - b.x;
+    float offsetY = a.y - b.y;
+    if (fabsf(offsetX) < halfWidth && fabsf(offsetY) < halfHeight) {
+        return true;
+    }
+    float distanceX = (a.velocityX - b.velocityX) * elapsed;
+    float distanceY = (a.velocityY - b.velocityY) * elapsed;
+
+    float entryX, exitX, entryY, exitY;
+    if (!SlabTimes(offsetX, distanceX, -halfWidth, halfWidth, entryX, exitX) ||
+        !SlabTimes(offsetY, distanceY, -halfHeight, halfHeight, entryY, exitY)) {
+        return false;
+    }
+    float entry = std::max(entryX, entryY);
+    float exit = std::min(exitX, exitY);
+    if (entry >= exit || entry < 0.0f || entry > 1.0f) {
+        return false;
+    }
+
+    impact.time = entry;
+    if (entryX > entryY) {
+        impact.normalX = distanceX > 0.0f ? -1.0f : 1.0f;
+    } else {
+        impact.normalY = distanceY > 0.0f ? -1.0f : 1.0f;
+    }
+    return true;
+}
+
+MovingBox RewoundBox(float previousX, float previousY, float x, float y, float width, float height, float elapsed) {
+    MovingBox box = {previousX, previousY, width, height, 0.0f, 0.0f};
+    if (elapsed > 0.0f) {
+        box.velocityX = (x - previousX) / elapsed;
+        box.velocityY = (y - previousY) / elapsed;
+    }
+    return box;
+}
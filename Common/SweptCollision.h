@@ -0,0 +1,26 @@
+#pragma once
+
+// Continuous collision between axis aligned boxes that move in straight lines
+// during a step, so fast movers and long frames cannot skip past each other.
+// Positions are box centres at the start of the step.
+struct MovingBox {
+    float x, y;
+    float width, height;
+    float velocityX, velocityY;
+};
+
+struct Impact {
+    // fraction of the step at which the boxes first touch, 0 if they already overlap
+    float time;
+    // axis the boxes met on, pointing from b towards a; zero when they started overlapping
+    float normalX, normalY;
+};
+
+// true if a and b touch at some point during the next elapsed seconds
+bool SweepBoxes(const MovingBox &a, const MovingBox &b, float elapsed, Impact &impact);
+
+// box of the given size that moves in a straight line from where it started the
+// step, (previousX, previousY), to where it ended it, (x, y), for tests run after
+// positions were already integrated. Going by the two positions rather than the
+// velocity keeps the path right for a mover that turned around during the step.
+MovingBox RewoundBox(float previousX, float previousY, float x, float y, float width, float height, float elapsed);
@@ -0,0 +1,119 @@
+#include "TextRenderer.h"
+#include "glm/gtc/matrix_transform.hpp"
+
+// x, y, u, v per vertex
+#define FLOATS_PER_VERTEX 4
+
+TextLabel::TextLabel(): size(0.0f), spacing(0.0f), vertexBuffer(0), vertexCount(0) {}
+
+void TextLabel::Setup(const AtlasRegion &font, float size, float spacing) {
+    this->font = font;
+    this->size = size;
+    this->spacing = spacing;
+    text.clear();
+    vertexCount = 0;
+    if (vertexBuffer == 0) {
+        glGenBuffers(1, &vertexBuffer);
+    }
+}
+
+void TextLabel::SetText(const std::string &text) {
+    if (text == this->text && vertexCount == (int)text.size() * 6) {
+        return;
+    }
+    this->text = text;
+    
+    float characterWidth = (font.u1 - font.u0) / 16.0f;
+    float characterHeight = (font.v1 - font.v0) / 16.0f;
+    
+    vertexData.clear();
+    for (size_t i = 0; i < text.size(); i++) {
+        int spriteIndex = (unsigned char)text[i];
+        float u = font.u0 + (float)(spriteIndex % 16) * characterWidth;
+        float v = font.v0 + (float)(spriteIndex / 16) * characterHeight;
+        float left = ((size + spacing) * i) + (-0.5f * size);
+        float right = ((size + spacing) * i) + (0.5f * size);
+        float top = 0.5f * size;
+        float bottom = -0.5f * size;
+        vertexData.insert(vertexData.end(), {
+            left, top, u, v,
+            left, bottom, u, v + characterHeight,
+            right, top, u + characterWidth, v,
+            right, bottom, u + characterWidth, v + characterHeight,
+            right, top, u + characterWidth, v,
+            left, bottom, u, v + characterHeight,
+        });
+    }
+    
+    vertexCount = (int)(vertexData.size() / FLOATS_PER_VERTEX);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(float), vertexData.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void TextLabel::Draw(ShaderProgram &program, float xPos, float yPos) {
+    if (vertexCount == 0) {
+        return;
+    }
+    
+    glm::mat4 modelMatrix = glm::mat4(1.0f);
+    modelMatrix = glm::translate(modelMatrix, glm::vec3(xPos, yPos, 0.0f));
+    program.SetModelMatrix(modelMatrix);
+    
+    glBindTexture(GL_TEXTURE_2D, font.texture);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    
+    GLsizei stride = FLOATS_PER_VERTEX * sizeof(float);
+    glVertexAttribPointer(program.positionAttribute, 2, GL_FLOAT, false, stride, (void*)0);
+    glEnableVertexAttribArray(program.positionAttribute);
+    
+    glVertexAttribPointer(program.texCoordAttribute, 2, GL_FLOAT, false, stride, (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(program.texCoordAttribute);
+    
+    glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+    
+    glDisableVertexAttribArray(program.positionAttribute);
+    glDisableVertexAttribArray(program.texCoordAttribute);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void TextLabel::Cleanup() {
+    if (vertexBuffer != 0) {
+        glDeleteBuffers(1, &vertexBuffer);
+        vertexBuffer = 0;
+    }
+    vertexCount = 0;
+    text.clear();
+}
+
+bool TextCache::Key::operator<(const Key &other) const {
+    if (text != other.text) return text < other.text;
+    if (size != other.size) return size < other.size;
+    if (spacing != other.spacing) return spacing < other.spacing;
+    if (texture != other.texture) return texture < other.texture;
+    if (u0 != other.u0) return u0 < other.u0;
+    return v0 < other.v0;
+}
+
+TextLabel &TextCache::Get(const AtlasRegion &font, const std::string &text, float size, float spacing) {
+    Key key = {text, size, spacing, font.texture, font.u0, font.v0};
+    std::map<Key, TextLabel>::iterator it = labels.find(key);
+    if (it != labels.end()) {
+        return it->second;
+    }
+    TextLabel &label = labels[key];
+    label.Setup(font, size, spacing);
+    label.SetText(text);
+    return label;
+}
+
+void TextCache::Draw(ShaderProgram &program, const AtlasRegion &font, const std::string &text, float size, float spacing, float xPos, float yPos) {
+    Get(font, text, size, spacing).Draw(program, xPos, yPos);
+}
+
+void TextCache::Cleanup() {
+    for (std::map<Key, TextLabel>::iterator it = labels.begin(); it != labels.end(); it++) {
+        it->second.Cleanup();
+    }
+    labels.clear();
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+#include <string>
+#include <vector>
+#include <map>
+#include "ShaderProgram.h"
+#include "TextureAtlas.h"
+
+// One string baked into a vertex buffer. SetText only rebuilds and re-uploads
+// the glyph quads when the string actually changes, Draw is a single draw call.
+class TextLabel {
+    public:
+    
+        TextLabel();
+    
+        // font is a 16x16 grid of ASCII glyphs, either a whole texture or an atlas region
+        void Setup(const AtlasRegion &font, float size, float spacing);
+        void SetText(const std::string &text);
+        void Draw(ShaderProgram &program, float xPos, float yPos);
+        void Cleanup();
+    
+        AtlasRegion font;
+        float size;
+        float spacing;
+        std::string text;
+    
+        GLuint vertexBuffer;
+        int vertexCount;
+    
+    private:
+    
+        std::vector<float> vertexData;
+};
+
+// Keeps a baked TextLabel for every constant string drawn through it, keyed by
+// (text, size, spacing, font). Use a TextLabel directly for strings that change.
+// Labels stay put until Cleanup, so a caller can keep the reference Get returns
+// instead of building the key every frame.
+class TextCache {
+    public:
+    
+        TextLabel &Get(const AtlasRegion &font, const std::string &text, float size, float spacing);
+        void Draw(ShaderProgram &program, const AtlasRegion &font, const std::string &text, float size, float spacing, float xPos, float yPos);
+        void Cleanup();
+    
+    private:
+    
+        struct Key {
+            std::string text;
+            float size;
+            float spacing;
+            GLuint texture;
+            float u0, v0;
+            bool operator<(const Key &other) const;
+        };
+    
+        std::map<Key, TextLabel> labels;
+};
@@ -0,0 +1,64 @@
+#include "TextureAtlas.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cassert>
+
+bool TextureAtlas::Load(GLuint texture, const char *manifestFile) {
+    std::ifstream infile(manifestFile);
+    if (infile.fail()) {
+        std::cout << "Error opening atlas manifest:" << manifestFile << std::endl;
+        return false;
+    }
+    
+    textureID = texture;
+    regions.clear();
+    
+    // first line: atlas <image> <width> <height>
+    std::string line;
+    std::string tag, image;
+    std::getline(infile, line);
+    std::istringstream header(line);
+    if (!(header >> tag >> image >> width >> height) || tag != "atlas") {
+        std::cout << "Bad atlas manifest header:" << manifestFile << std::endl;
+        return false;
+    }
+    
+    // then one sprite per line: <name> <x> <y> <w> <h> in pixels
+    while (std::getline(infile, line)) {
+        std::istringstream sstream(line);
+        std::string name;
+        int x, y, w, h;
+        if (!(sstream >> name >> x >> y >> w >> h)) {
+            continue;
+        }
+        AtlasRegion region;
+        region.texture = texture;
+        region.u0 = (float)x / (float)width;
+        region.v0 = (float)y / (float)height;
+        region.u1 = (float)(x + w) / (float)width;
+        region.v1 = (float)(y + h) / (float)height;
+        region.width = w;
+        region.height = h;
+        regions[name] = region;
+    }
+    return true;
+}
+
+bool TextureAtlas::HasRegion(const std::string &name) const {
+    return regions.find(name) != regions.end();
+}
+
+void TextureAtlas::AddImage(const std::string &name, GLuint texture, int width, int height) {
+    AtlasRegion region = {texture, 0.0f, 0.0f, 1.0f, 1.0f, width, height};
+    regions[name] = region;
+}
+
+const AtlasRegion &TextureAtlas::GetRegion(const std::string &name) const {
+    std::map<std::string, AtlasRegion>::const_iterator it = regions.find(name);
+    if (it == regions.end()) {
+        std::cout << "Sprite not found in atlas: " << name << std::endl;
+        assert(false);
+    }
+    return it->second;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+#include <string>
+#include <map>
+
+// A named sub-rectangle of a packed atlas texture.
+struct AtlasRegion {
+    GLuint texture;
+    float u0, v0, u1, v1;
+    int width, height;
+};
+
+// Runtime side of AtlasPacker: maps sprite names to UV rects inside one texture.
+class TextureAtlas {
+    public:
+    
+        // texture is the already uploaded atlas image, manifestFile the text manifest written next to it
+        bool Load(GLuint texture, const char *manifestFile);
+    
+        const AtlasRegion &GetRegion(const std::string &name) const;
+        bool HasRegion(const std::string &name) const;
+        // a sprite drawn from a texture of its own rather than from the packed image
+        void AddImage(const std::string &name, GLuint texture, int width, int height);
+    
+        GLuint textureID;
+        int width;
+        int height;
+        std::map<std::string, AtlasRegion> regions;
+};
@@ -0,0 +1,159 @@
+// Offline texture cooker.
+//
+// Decodes a PNG, GIF or TGA once and writes it as a KTX file of RGBA8 pixels
+// with the whole mip chain, which KtxTexture uploads with one file read and
+// no decoding. Each level halves the one above with an alpha weighted 2x2
+// box filter, so transparent texels do not darken the edges of sprites.
+// Mipmaps of a packed atlas average across sprite borders at small sizes,
+// the padding AtlasPacker leaves between sprites keeps that out of sight.
+// Sheets with no padding, like the nearest filtered pixel art in the
+// homeworks, should be cooked with --no-mips: their mips would bleed between
+// frames and only add a third to the texture's memory.
+//
+// TextureManager picks up a .ktx next to the image it was asked for, so the
+// cooked files are build outputs and stay out of the repository.
+//
+//   g++ -O2 -std=c++11 $(sdl2-config --cflags) TextureCooker.cpp KtxTexture.cpp -lGL -o TextureCooker
+//   (-framework OpenGL instead of -lGL on macOS)
+//   ./TextureCooker <image> <output.ktx> [--no-mips]
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#include "KtxTexture.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+
+// rows top to bottom, as stb_image returns them and the games draw them
+static const char ORIENTATION_KEY[] = "KTXorientation";
+static const char ORIENTATION_VALUE[] = "S=r,T=d";
+
+struct MipLevel {
+    int width;
+    int height;
+    std::vector<unsigned char> pixels;
+};
+
+static double Milliseconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// halves a level, the last row or column of an odd sized level is folded into its neighbour
+static void Downsample(const MipLevel &source, MipLevel &level) {
+    level.width = source.width > 1 ? source.width / 2 : 1;
+    level.height = source.height > 1 ? source.height / 2 : 1;
+    level.pixels.resize((size_t)level.width * level.height * 4);
+    for (int y = 0; y < level.height; y++) {
+        for (int x = 0; x < level.width; x++) {
+            unsigned int color[3] = {0, 0, 0};
+            unsigned int alpha = 0;
+            for (int sample = 0; sample < 4; sample++) {
+                int sourceX = std::min(x * 2 + (sample & 1), source.width - 1);
+                int sourceY = std::min(y * 2 + (sample >> 1), source.height - 1);
+                const unsigned char *texel = &source.pixels[((size_t)sourceY * source.width + sourceX) * 4];
+                for (int c = 0; c < 3; c++) {
+                    color[c] += texel[c] * texel[3];
+                }
+                alpha += texel[3];
+            }
+            unsigned char *texel = &level.pixels[((size_t)y * level.width + x) * 4];
+            for (int c = 0; c < 3; c++) {
+                texel[c] = (unsigned char)(alpha > 0 ? (color[c] + alpha / 2) / alpha : 0);
+            }
+            texel[3] = (unsigned char)((alpha + 2) / 4);
+        }
+    }
+}
+
+static void WriteU32(std::ofstream &file, unsigned int value) {
+    for (int i = 0; i < 4; i++) {
+        file.put((char)((value >> (i * 8)) & 0xFF));
+    }
+}
+
+static bool WriteKtx(const std::string &path, const std::vector<MipLevel> &levels) {
+    std::ofstream file(path.c_str(), std::ios::binary);
+    if (file.fail()) {
+        return false;
+    }
+    // key and value with their terminators, padded to 4 bytes
+    unsigned int keyValueLength = (unsigned int)(sizeof(ORIENTATION_KEY) + sizeof(ORIENTATION_VALUE));
+    unsigned int keyValuePadding = (4 - keyValueLength % 4) % 4;
+
+    file.write((const char *)KTX_IDENTIFIER, KTX_IDENTIFIER_LENGTH);
+    WriteU32(file, KTX_ENDIANNESS);
+    WriteU32(file, GL_UNSIGNED_BYTE);
+    WriteU32(file, 1);
+    WriteU32(file, GL_RGBA);
+    WriteU32(file, GL_RGBA8);
+    WriteU32(file, GL_RGBA);
+    WriteU32(file, (unsigned int)levels[0].width);
+    WriteU32(file, (unsigned int)levels[0].height);
+    WriteU32(file, 0);
+    WriteU32(file, 0);
+    WriteU32(file, 1);
+    WriteU32(file, (unsigned int)levels.size());
+    WriteU32(file, 4 + keyValueLength + keyValuePadding);
+
+    WriteU32(file, keyValueLength);
+    file.write(ORIENTATION_KEY, sizeof(ORIENTATION_KEY));
+    file.write(ORIENTATION_VALUE, sizeof(ORIENTATION_VALUE));
+    for (unsigned int i = 0; i < keyValuePadding; i++) {
+        file.put(0);
+    }
+
+    for (size_t i = 0; i < levels.size(); i++) {
+        WriteU32(file, (unsigned int)levels[i].pixels.size());
+        file.write((const char *)&levels[i].pixels[0], levels[i].pixels.size());
+    }
+    return !file.fail();
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        std::cout << "usage: TextureCooker <image> <output.ktx> [--no-mips]" << std::endl;
+        return 1;
+    }
+    std::string output = argv[2];
+    bool mipmaps = !(argc > 3 && strcmp(argv[3], "--no-mips") == 0);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<MipLevel> levels(1);
+    int components;
+    unsigned char *image = stbi_load(argv[1], &levels[0].width, &levels[0].height, &components, STBI_rgb_alpha);
+    if (image == NULL) {
+        std::cout << "Unable to load image " << argv[1] << std::endl;
+        return 1;
+    }
+    levels[0].pixels.assign(image, image + (size_t)levels[0].width * levels[0].height * 4);
+    stbi_image_free(image);
+    double decodeTime = Milliseconds(start);
+
+    while (mipmaps && (levels.back().width > 1 || levels.back().height > 1) && levels.size() < KTX_MAX_LEVELS) {
+        MipLevel level;
+        Downsample(levels.back(), level);
+        levels.push_back(level);
+    }
+
+    if (!WriteKtx(output, levels)) {
+        std::cout << "Unable to write " << output << std::endl;
+        return 1;
+    }
+
+    // reading it back is what the game pays instead of the decode
+    start = std::chrono::steady_clock::now();
+    KtxTexture cooked;
+    if (!cooked.Load(output.c_str())) {
+        return 1;
+    }
+    double loadTime = Milliseconds(start);
+
+    printf("%s: %d x %d, %d levels, %.1f KB\n", output.c_str(), cooked.width, cooked.height, cooked.levelCount, cooked.Bytes() / 1024.0);
+    printf("image decode %.2f ms, KTX load %.2f ms\n", decodeTime, loadTime);
+    return 0;
+}
@@ -0,0 +1,204 @@
+#include "TextureManager.h"
+#include "KtxTexture.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <vector>
+#include <cstdio>
+#include <string>
+#include <iostream>
+
+// images are uploaded as RGBA8 without mipmaps, cooked textures bring their own levels
+#define TEXTURE_BYTES_PER_PIXEL 4
+
+TextureManager::TextureManager(): textures(TEXTURE_CAPACITY), useCounter(0), residentBytes(0) {}
+
+Handle TextureManager::Acquire(const char *path, GLint filter) {
+    std::pair<std::string, GLint> key(path, filter);
+    std::map<std::pair<std::string, GLint>, Handle>::iterator found = byPath.find(key);
+    if (found != byPath.end()) {
+        textures.Get(found->second)->references++;
+        return found->second;
+    }
+
+    ManagedTexture texture = {path, filter, 0, 0, 0, 0, 1, 0, false};
+    Handle handle = textures.Spawn(texture);
+    if (!textures.Get(handle)) {
+        std::cout << "No room for texture " << path << ", " << TEXTURE_CAPACITY << " are already loaded" << std::endl;
+        return handle;
+    }
+    byPath[key] = handle;
+    return handle;
+}
+
+Handle TextureManager::Adopt(const char *path, GLuint texture, GLint filter) {
+    Handle handle = Acquire(path, filter);
+    ManagedTexture *managed = textures.Get(handle);
+    if (!managed) {
+        glDeleteTextures(1, &texture);
+        return handle;
+    }
+    if (managed->texture != 0) {
+        // already resident, the second copy is not needed
+        glDeleteTextures(1, &texture);
+        return handle;
+    }
+    managed->texture = texture;
+    managed->failed = false;
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &managed->width);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &managed->height);
+    // levels that were never specified report a width of 0
+    managed->bytes = 0;
+    for (int level = 0; level < KTX_MAX_LEVELS; level++) {
+        GLint width, height;
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH, &width);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT, &height);
+        if (width == 0) {
+            break;
+        }
+        managed->bytes += (size_t)width * height * TEXTURE_BYTES_PER_PIXEL;
+    }
+    residentBytes += managed->bytes;
+    return handle;
+}
+
+void TextureManager::Release(Handle texture) {
+    ManagedTexture *managed = textures.Get(texture);
+    if (managed && managed->references > 0) {
+        managed->references--;
+    }
+}
+
+GLuint TextureManager::Get(Handle texture) {
+    ManagedTexture *managed = textures.Get(texture);
+    if (!managed) {
+        return 0;
+    }
+    managed->lastUse = ++useCounter;
+    if (managed->texture == 0 && !managed->failed) {
+        managed->failed = !Upload(*managed);
+    }
+    return managed->texture;
+}
+
+bool TextureManager::Load(Handle texture) {
+    return Get(texture) != 0;
+}
+
+// TextureCooker's output for an image, spritesheet.ktx for spritesheet.png, or an empty string when it was not cooked
+static std::string CookedPath(const std::string &path) {
+    size_t dot = path.find_last_of('.');
+    size_t slash = path.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return "";
+    }
+    std::string cooked = path.substr(0, dot) + ".ktx";
+    FILE *file = fopen(cooked.c_str(), "rb");
+    if (file == NULL) {
+        return "";
+    }
+    fclose(file);
+    return cooked;
+}
+
+bool TextureManager::Upload(ManagedTexture &texture) {
+    bool isKtx = IsKtxPath(texture.path.c_str());
+    std::string cookedPath = isKtx ? texture.path : CookedPath(texture.path);
+    if (!cookedPath.empty()) {
+        KtxTexture cooked;
+        if (cooked.Load(cookedPath.c_str())) {
+            texture.texture = cooked.Upload(texture.filter);
+            texture.width = cooked.width;
+            texture.height = cooked.height;
+            texture.bytes = cooked.Bytes();
+            residentBytes += texture.bytes;
+            return true;
+        }
+        // a cooked copy that does not load leaves the image itself
+        if (isKtx) {
+            return false;
+        }
+    }
+    int components;
+    unsigned char *image = stbi_load(texture.path.c_str(), &texture.width, &texture.height, &components, STBI_rgb_alpha);
+    if (image == NULL) {
+        std::cout << "Unable to load image " << texture.path << ". Make sure the path is correct\n";
+        return false;
+    }
+    glGenTextures(1, &texture.texture);
+    glBindTexture(GL_TEXTURE_2D, texture.texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texture.width, texture.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture.filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, texture.filter);
+    stbi_image_free(image);
+    texture.bytes = (size_t)texture.width * texture.height * TEXTURE_BYTES_PER_PIXEL;
+    residentBytes += texture.bytes;
+    return true;
+}
+
+void TextureManager::Free(ManagedTexture &texture) {
+    if (texture.texture == 0) {
+        return;
+    }
+    glDeleteTextures(1, &texture.texture);
+    texture.texture = 0;
+    residentBytes -= texture.bytes;
+    texture.bytes = 0;
+}
+
+void TextureManager::Unload(Handle texture) {
+    ManagedTexture *managed = textures.Get(texture);
+    if (managed) {
+        Free(*managed);
+        managed->failed = false;
+    }
+}
+
+static bool LessRecentlyUsed(const std::pair<unsigned int, Handle> &a, const std::pair<unsigned int, Handle> &b) {
+    return a.first < b.first;
+}
+
+size_t TextureManager::Evict(size_t budgetBytes) {
+    std::vector<std::pair<unsigned int, Handle> > unreferenced;
+    for (size_t i = 0; i < textures.Size(); i++) {
+        if (textures[i].references == 0) {
+            unreferenced.push_back(std::make_pair(textures[i].lastUse, textures.HandleAt(i)));
+        }
+    }
+    std::sort(unreferenced.begin(), unreferenced.end(), LessRecentlyUsed);
+
+    size_t before = residentBytes;
+    for (size_t i = 0; i < unreferenced.size() && residentBytes > budgetBytes; i++) {
+        ManagedTexture *managed = textures.Get(unreferenced[i].second);
+        Free(*managed);
+        byPath.erase(std::make_pair(managed->path, managed->filter));
+        textures.Despawn(unreferenced[i].second);
+    }
+    return before - residentBytes;
+}
+
+const ManagedTexture *TextureManager::Info(Handle texture) {
+    return textures.Get(texture);
+}
+
+size_t TextureManager::ResidentBytes() const {
+    return residentBytes;
+}
+
+void TextureManager::PrintUsage() const {
+    for (size_t i = 0; i < textures.Size(); i++) {
+        const ManagedTexture &texture = textures[i];
+        printf("%-48s %5d x %-5d %8.1f KB  %d refs%s\n", texture.path.c_str(), texture.width, texture.height,
+               texture.bytes / 1024.0, texture.references, texture.failed ? "  (failed to load)" : texture.texture != 0 ? "" : "  (not resident)");
+    }
+    printf("%d textures, %.1f KB resident\n", (int)textures.Size(), residentBytes / 1024.0);
+}
+
+void TextureManager::Cleanup() {
+    for (size_t i = 0; i < textures.Size(); i++) {
+        Free(textures[i]);
+    }
+    textures.Clear();
+    byPath.clear();
+    residentBytes = 0;
+}
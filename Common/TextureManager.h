@@ -0,0 +1,79 @@
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+#include "HandlePool.h"
+#include <string>
+#include <map>
+#include <utility>
+
+#define TEXTURE_CAPACITY 256
+
+struct ManagedTexture {
+    std::string path;
+    GLint filter;
+    // 0 while not resident
+    GLuint texture;
+    int width;
+    int height;
+    // GPU memory while resident
+    size_t bytes;
+    int references;
+    // value of the manager's use counter at the last Get, for least recently used eviction
+    unsigned int lastUse;
+    // set when loading failed, Get returns 0 without trying again until Unload or Evict
+    bool failed;
+};
+
+// Textures loaded from image files, or .ktx files cooked by TextureCooker,
+// and shared by path, in place of a LoadTexture per main.cpp. An image with a
+// cooked .ktx of the same name next to it loads from that instead, so a
+// project can name its PNGs and still skip the decode once they are cooked. Acquire hands
+// out a handle holding one reference, and the image is only decoded and
+// uploaded the first time Get or Load needs it. A texture whose references
+// are all released stays resident, so the next level asking for the same
+// sheet gets it without decoding it again. Evict frees unreferenced
+// textures, least recently used first, until what is left fits a budget.
+class TextureManager {
+    public:
+
+        TextureManager();
+
+        // the same path and filter always give the same texture
+        Handle Acquire(const char *path, GLint filter = GL_NEAREST);
+        // takes over a texture uploaded elsewhere, e.g. by AssetLoader, as if Acquire had loaded it
+        Handle Adopt(const char *path, GLuint texture, GLint filter);
+        void Release(Handle texture);
+
+        // the texture object, loaded on first use, 0 if the image could not be read.
+        // a failed load is reported once and not retried
+        GLuint Get(Handle texture);
+        // loads ahead of the first Get, so the decode happens at a convenient time
+        bool Load(Handle texture);
+        // frees the GPU copy now even if still referenced, the next Get loads it again,
+        // also after a failed load
+        void Unload(Handle texture);
+        // unloads and forgets unreferenced textures until at most budgetBytes stay resident, returns the bytes freed
+        size_t Evict(size_t budgetBytes);
+
+        // NULL for a handle that was evicted
+        const ManagedTexture *Info(Handle texture);
+        size_t ResidentBytes() const;
+        // one line per texture with its size, memory and references
+        void PrintUsage() const;
+
+        // deletes every texture, needs the GL context that created them
+        void Cleanup();
+
+    private:
+
+        bool Upload(ManagedTexture &texture);
+        void Free(ManagedTexture &texture);
+
+        Pool<ManagedTexture> textures;
+        std::map<std::pair<std::string, GLint>, Handle> byPath;
+        unsigned int useCounter;
+        size_t residentBytes;
+};
@@ -0,0 +1,7 @@
+
+uniform sampler2D diffuse;
+varying vec2 texCoordVar;
+
+void main() {
+    gl_FragColor = texture2D(diffuse, texCoordVar);
+}
\ No newline at end of file
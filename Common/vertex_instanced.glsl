@@ -0,0 +1,23 @@
+attribute vec4 position;
+attribute vec2 texCoord;
+
+attribute vec4 instanceTransform;
+attribute float instanceRotation;
+attribute vec4 instanceUV;
+
+uniform mat4 viewMatrix;
+uniform mat4 projectionMatrix;
+
+varying vec2 texCoordVar;
+
+void main()
+{
+	// instanceTransform is x, y, scaleX, scaleY; instanceUV is u, v, width, height
+	float s = sin(instanceRotation);
+	float c = cos(instanceRotation);
+	vec2 scaled = position.xy * instanceTransform.zw;
+	vec2 rotated = vec2(scaled.x * c - scaled.y * s, scaled.x * s + scaled.y * c);
+	vec4 p = viewMatrix * vec4(rotated + instanceTransform.xy, 0.0, 1.0);
+    texCoordVar = instanceUV.xy + texCoord * instanceUV.zw;
+	gl_Position = projectionMatrix * p;
+}
\ No newline at end of file
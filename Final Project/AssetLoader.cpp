@@ -0,0 +1,168 @@
+#include "AssetLoader.h"
+#include "stb_image.h"
+#include <iostream>
+#include <cstring>
+
+AssetLoader::AssetLoader(): quit(false), queued(0), finished(0), pixelBuffer(0) {}
+
+AssetLoader::~AssetLoader() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        quit = true;
+        requests.clear();
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    for (size_t i = 0; i < decoded.size(); i++) {
+        stbi_image_free(decoded[i].pixels);
+        delete decoded[i].cooked;
+    }
+}
+
+void AssetLoader::Cleanup() {
+    if (pixelBuffer != 0) {
+        glDeleteBuffers(1, &pixelBuffer);
+        pixelBuffer = 0;
+    }
+}
+
+void AssetLoader::Queue(const Request &request) {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        requests.push_back(request);
+        queued++;
+    }
+    wake.notify_one();
+}
+
+void AssetLoader::QueueTexture(const char *path, GLuint *texture, GLint filter) {
+    Request request = {ASSET_TEXTURE, path, texture, filter, NULL, NULL};
+    Queue(request);
+}
+
+void AssetLoader::QueueSound(const char *path, Mix_Chunk **chunk) {
+    Request request = {ASSET_SOUND, path, NULL, 0, chunk, NULL};
+    Queue(request);
+}
+
+void AssetLoader::QueueMusic(const char *path, Mix_Music **music) {
+    Request request = {ASSET_MUSIC, path, NULL, 0, NULL, music};
+    Queue(request);
+}
+
+void AssetLoader::Start(int threads) {
+    for (int i = 0; i < threads; i++) {
+        workers.push_back(std::thread(&AssetLoader::WorkerMain, this));
+    }
+}
+
+void AssetLoader::WorkerMain() {
+    while (true) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            while (!quit && requests.empty()) {
+                wake.wait(guard);
+            }
+            if (quit) {
+                return;
+            }
+            request = requests.front();
+            requests.pop_front();
+        }
+
+        if (request.kind == ASSET_TEXTURE) {
+            DecodedImage image = {NULL, 0, 0, request.texture, request.filter, NULL};
+            if (IsKtxPath(request.path.c_str())) {
+                // nothing to decode, the read is all the work there is
+                image.cooked = new KtxTexture();
+                image.cooked->Load(request.path.c_str());
+            } else {
+                int components;
+                image.pixels = stbi_load(request.path.c_str(), &image.width, &image.height, &components, STBI_rgb_alpha);
+                if (image.pixels == NULL) {
+                    std::cout << "Unable to load image " << request.path << ". Make sure the path is correct\n";
+                }
+            }
+            // the texture is still owed an upload, so it is not finished yet
+            std::lock_guard<std::mutex> guard(lock);
+            decoded.push_back(image);
+            continue;
+        }
+
+        if (request.kind == ASSET_SOUND) {
+            *request.chunk = Mix_LoadWAV(request.path.c_str());
+        } else {
+            *request.music = Mix_LoadMUS(request.path.c_str());
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        finished++;
+    }
+}
+
+void AssetLoader::Update() {
+    DecodedImage image;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (decoded.empty()) {
+            return;
+        }
+        image = decoded.back();
+        decoded.pop_back();
+    }
+    Upload(image);
+    stbi_image_free(image.pixels);
+    delete image.cooked;
+
+    std::lock_guard<std::mutex> guard(lock);
+    finished++;
+}
+
+void AssetLoader::Upload(const DecodedImage &image) {
+    if (image.cooked != NULL) {
+        *image.texture = image.cooked->Upload(image.filter);
+        return;
+    }
+    // an image that failed to decode leaves its texture at 0, like a cooked one that failed to read
+    if (image.pixels == NULL) {
+        *image.texture = 0;
+        return;
+    }
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, image.filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, image.filter);
+    *image.texture = texture;
+
+    // orphaning the buffer lets the driver hand out fresh memory instead of waiting on the last upload
+    size_t size = (size_t)image.width * image.height * 4;
+    if (pixelBuffer == 0) {
+        glGenBuffers(1, &pixelBuffer);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+    void *mapped = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+    if (mapped != NULL) {
+        memcpy(mapped, image.pixels, size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    } else {
+        // no mapping on this driver, upload straight from client memory
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels);
+    }
+}
+
+float AssetLoader::Progress() {
+    std::lock_guard<std::mutex> guard(lock);
+    return queued > 0 ? (float)finished / (float)queued : 1.0f;
+}
+
+bool AssetLoader::Done() {
+    std::lock_guard<std::mutex> guard(lock);
+    return finished == queued;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+#include <SDL_mixer.h>
+#include "KtxTexture.h"
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Loads images and sounds on worker threads while the main thread keeps
+// drawing. Workers decode PNG/TGA files and audio, and read .ktx files cooked
+// by TextureCooker as they are. Decoded pixels come back to the GL thread,
+// which copies them into a pixel buffer object and creates the texture from
+// it, cooked textures are uploaded level by level. Results are written through the pointers given when
+// queueing, and only once Done() says so may they be read.
+class AssetLoader {
+    public:
+
+        AssetLoader();
+        // waits for the workers, anything still queued is dropped
+        ~AssetLoader();
+
+        // assets can still be queued after Start, Done() is false again until they are ready.
+        // a texture that fails to load is left at 0
+        void QueueTexture(const char *path, GLuint *texture, GLint filter);
+        void QueueSound(const char *path, Mix_Chunk **chunk);
+        void QueueMusic(const char *path, Mix_Music **music);
+        void Start(int threads = 2);
+
+        // uploads one finished image, call on the GL thread every frame
+        void Update();
+        // deletes the pixel buffer used for uploads, call on the GL thread once loading is
+        // over and before the context is destroyed, the destructor has no context to use
+        void Cleanup();
+
+        // share of queued assets that are ready, images count once uploaded
+        float Progress();
+        bool Done();
+
+    private:
+
+        enum AssetKind {ASSET_TEXTURE, ASSET_SOUND, ASSET_MUSIC};
+
+        struct Request {
+            AssetKind kind;
+            std::string path;
+            GLuint *texture;
+            GLint filter;
+            Mix_Chunk **chunk;
+            Mix_Music **music;
+        };
+
+        struct DecodedImage {
+            unsigned char *pixels;
+            int width;
+            int height;
+            GLuint *texture;
+            GLint filter;
+            // set instead of pixels for .ktx files
+            KtxTexture *cooked;
+        };
+
+        void Queue(const Request &request);
+        void WorkerMain();
+        void Upload(const DecodedImage &image);
+
+        std::vector<std::thread> workers;
+        std::mutex lock;
+        std::condition_variable wake;
+        std::deque<Request> requests;
+        std::vector<DecodedImage> decoded;
+        bool quit;
+        int queued;
+        int finished;
+
+        GLuint pixelBuffer;
+};
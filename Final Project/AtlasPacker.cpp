@@ -0,0 +1,290 @@
+// Offline sprite atlas packer.
+//
+// Packs every .png in a directory into one RGBA atlas with a skyline
+// bottom-left packer and writes <output>.tga plus a <output>.atlas text
+// manifest that TextureAtlas reads at runtime. TextureCooker in Common/
+// turns the .tga into the mipmapped sprites.ktx the game loads.
+//
+//   g++ -O2 -std=c++11 -I../Common AtlasPacker.cpp -o AtlasPacker
+//   ./AtlasPacker <png directory> <output> [padding]
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#include <dirent.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+
+struct Sprite {
+    std::string name;
+    int width, height;
+    int x, y;
+    unsigned char *pixels;
+};
+
+struct SkylineNode {
+    int x, y, width;
+};
+
+class SkylinePacker {
+    public:
+
+        SkylinePacker(int width, int height): width(width), height(height) {
+            SkylineNode node = {0, 0, width};
+            skyline.push_back(node);
+        }
+
+        // places a w x h rect at the lowest, then leftmost, spot on the skyline
+        bool Insert(int w, int h, int &outX, int &outY) {
+            int bestIndex = -1;
+            int bestY = height;
+            int bestX = width;
+            for (size_t i = 0; i < skyline.size(); i++) {
+                int y;
+                if (Fits(i, w, h, y) && (y < bestY || (y == bestY && skyline[i].x < bestX))) {
+                    bestIndex = (int)i;
+                    bestY = y;
+                    bestX = skyline[i].x;
+                }
+            }
+            if (bestIndex < 0) {
+                return false;
+            }
+            AddLevel(bestIndex, bestX, bestY, w, h);
+            outX = bestX;
+            outY = bestY;
+            return true;
+        }
+
+    private:
+
+        bool Fits(size_t index, int w, int h, int &outY) {
+            int x = skyline[index].x;
+            if (x + w > width) {
+                return false;
+            }
+            int widthLeft = w;
+            int y = skyline[index].y;
+            while (widthLeft > 0) {
+                y = std::max(y, skyline[index].y);
+                if (y + h > height) {
+                    return false;
+                }
+                widthLeft -= skyline[index].width;
+                index++;
+            }
+            outY = y;
+            return true;
+        }
+
+        void AddLevel(int index, int x, int y, int w, int h) {
+            SkylineNode node = {x, y + h, w};
+            skyline.insert(skyline.begin() + index, node);
+
+            // shrink or drop the nodes now covered by the new one
+            for (size_t i = index + 1; i < skyline.size(); i++) {
+                SkylineNode &previous = skyline[i - 1];
+                int shrink = previous.x + previous.width - skyline[i].x;
+                if (shrink <= 0) {
+                    break;
+                }
+                skyline[i].x += shrink;
+                skyline[i].width -= shrink;
+                if (skyline[i].width <= 0) {
+                    skyline.erase(skyline.begin() + i);
+                    i--;
+                } else {
+                    break;
+                }
+            }
+
+            // merge neighbours at the same height
+            for (size_t i = 0; i + 1 < skyline.size(); i++) {
+                if (skyline[i].y == skyline[i + 1].y) {
+                    skyline[i].width += skyline[i + 1].width;
+                    skyline.erase(skyline.begin() + i + 1);
+                    i--;
+                }
+            }
+        }
+
+        int width;
+        int height;
+        std::vector<SkylineNode> skyline;
+};
+
+static bool EndsWith(const std::string &str, const std::string &suffix) {
+    return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static bool LoadSprites(const std::string &directory, std::vector<Sprite> &sprites) {
+    DIR *dir = opendir(directory.c_str());
+    if (dir == NULL) {
+        std::cout << "Unable to open directory " << directory << std::endl;
+        return false;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        std::string file = entry->d_name;
+        if (!EndsWith(file, ".png")) {
+            continue;
+        }
+        Sprite sprite;
+        int comp;
+        std::string path = directory + "/" + file;
+        sprite.pixels = stbi_load(path.c_str(), &sprite.width, &sprite.height, &comp, STBI_rgb_alpha);
+        if (sprite.pixels == NULL) {
+            std::cout << "Unable to load image " << path << std::endl;
+            continue;
+        }
+        sprite.name = file.substr(0, file.size() - 4);
+        sprite.x = sprite.y = 0;
+        sprites.push_back(sprite);
+    }
+    closedir(dir);
+    return !sprites.empty();
+}
+
+static bool CompareSprites(const Sprite &a, const Sprite &b) {
+    if (a.height != b.height) {
+        return a.height > b.height;
+    }
+    return a.name < b.name;
+}
+
+// tries power of two sizes until every padded sprite fits
+static bool PackSprites(std::vector<Sprite> &sprites, int padding, int &atlasWidth, int &atlasHeight) {
+    int area = 0;
+    int widest = 0;
+    for (size_t i = 0; i < sprites.size(); i++) {
+        area += (sprites[i].width + padding * 2) * (sprites[i].height + padding * 2);
+        widest = std::max(widest, sprites[i].width + padding * 2);
+    }
+    atlasWidth = 64;
+    while (atlasWidth * atlasWidth < area || atlasWidth < widest) {
+        atlasWidth *= 2;
+    }
+    atlasHeight = atlasWidth / 2;
+
+    while (atlasWidth <= 8192) {
+        SkylinePacker packer(atlasWidth, atlasHeight);
+        bool packed = true;
+        for (size_t i = 0; i < sprites.size() && packed; i++) {
+            int x, y;
+            packed = packer.Insert(sprites[i].width + padding * 2, sprites[i].height + padding * 2, x, y);
+            sprites[i].x = x + padding;
+            sprites[i].y = y + padding;
+        }
+        if (packed) {
+            return true;
+        }
+        if (atlasHeight < atlasWidth) {
+            atlasHeight *= 2;
+        } else {
+            atlasWidth *= 2;
+        }
+    }
+    return false;
+}
+
+// copies each sprite and extrudes its edge pixels into the padding so linear filtering does not bleed
+static void BlitSprites(const std::vector<Sprite> &sprites, int padding, int atlasWidth, int atlasHeight, std::vector<unsigned char> &atlas) {
+    atlas.assign(atlasWidth * atlasHeight * 4, 0);
+    for (size_t i = 0; i < sprites.size(); i++) {
+        const Sprite &sprite = sprites[i];
+        for (int y = -padding; y < sprite.height + padding; y++) {
+            int srcY = std::min(std::max(y, 0), sprite.height - 1);
+            for (int x = -padding; x < sprite.width + padding; x++) {
+                int srcX = std::min(std::max(x, 0), sprite.width - 1);
+                const unsigned char *src = sprite.pixels + (srcY * sprite.width + srcX) * 4;
+                unsigned char *dst = &atlas[((sprite.y + y) * atlasWidth + sprite.x + x) * 4];
+                memcpy(dst, src, 4);
+            }
+        }
+    }
+}
+
+// uncompressed 32 bit TGA with a top-left origin
+static bool WriteTGA(const std::string &file, int width, int height, const std::vector<unsigned char> &rgba) {
+    FILE *out = fopen(file.c_str(), "wb");
+    if (out == NULL) {
+        return false;
+    }
+    unsigned char header[18] = {0};
+    header[2] = 2;
+    header[12] = width & 0xFF;
+    header[13] = (width >> 8) & 0xFF;
+    header[14] = height & 0xFF;
+    header[15] = (height >> 8) & 0xFF;
+    header[16] = 32;
+    header[17] = 0x28;
+    fwrite(header, 1, sizeof(header), out);
+
+    std::vector<unsigned char> bgra(rgba.size());
+    for (size_t i = 0; i < rgba.size(); i += 4) {
+        bgra[i] = rgba[i + 2];
+        bgra[i + 1] = rgba[i + 1];
+        bgra[i + 2] = rgba[i];
+        bgra[i + 3] = rgba[i + 3];
+    }
+    fwrite(bgra.data(), 1, bgra.size(), out);
+    fclose(out);
+    return true;
+}
+
+static bool WriteManifest(const std::string &file, const std::string &image, int width, int height, const std::vector<Sprite> &sprites) {
+    std::ofstream out(file.c_str());
+    if (out.fail()) {
+        return false;
+    }
+    out << "atlas " << image << " " << width << " " << height << "\n";
+    for (size_t i = 0; i < sprites.size(); i++) {
+        out << sprites[i].name << " " << sprites[i].x << " " << sprites[i].y << " " << sprites[i].width << " " << sprites[i].height << "\n";
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        std::cout << "usage: AtlasPacker <png directory> <output> [padding]" << std::endl;
+        return 1;
+    }
+    std::string directory = argv[1];
+    std::string output = argv[2];
+    int padding = argc > 3 ? atoi(argv[3]) : 2;
+
+    std::vector<Sprite> sprites;
+    if (!LoadSprites(directory, sprites)) {
+        std::cout << "No sprites found in " << directory << std::endl;
+        return 1;
+    }
+    std::sort(sprites.begin(), sprites.end(), CompareSprites);
+
+    int atlasWidth, atlasHeight;
+    if (!PackSprites(sprites, padding, atlasWidth, atlasHeight)) {
+        std::cout << "Sprites do not fit in an 8192 pixel atlas" << std::endl;
+        return 1;
+    }
+
+    std::vector<unsigned char> atlas;
+    BlitSprites(sprites, padding, atlasWidth, atlasHeight, atlas);
+
+    std::string image = output + ".tga";
+    std::string manifest = output + ".atlas";
+    std::string imageName = image.substr(image.find_last_of('/') + 1);
+    if (!WriteTGA(image, atlasWidth, atlasHeight, atlas) || !WriteManifest(manifest, imageName, atlasWidth, atlasHeight, sprites)) {
+        std::cout << "Unable to write " << output << std::endl;
+        return 1;
+    }
+
+    std::cout << "Packed " << sprites.size() << " sprites into " << atlasWidth << "x" << atlasHeight << std::endl;
+    for (size_t i = 0; i < sprites.size(); i++) {
+        stbi_image_free(sprites[i].pixels);
+    }
+    return 0;
+}
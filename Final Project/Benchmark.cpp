@@ -0,0 +1,733 @@
+// Microbenchmarks for the simulation hot paths of the Final Project, HW3 and
+// HW5, built from the same game logic sources without SDL or GL:
+//
+//   integrate_*       old array-of-structs Entity update against EntityStore, plain and SIMD
+//   update_hazards    Update()'s crate and bird step, single threaded
+//   collide_plane     the plane's broadphase query and swept didCollideWith test
+//   broadphase_*      overlapping hazard pairs by testing every pair and with SpatialHash
+//   spawn_despawn     Pool spawning a full pool and despawning it by handle in random order
+//   hw3_march         the invader formation's march
+//   hw3_grid          BulletCollisions::BuildGrid over a block of invaders at the game's spacing
+//   hw3_bullets       BulletCollisions::TestBullets against that block, per bullet; the run
+//                     exits with 1 if the largest count costs over 3x the smallest per bullet
+//   hw5_tile_move     TileCollision::Move for falling and running players over a level
+//   tunneling_*       hits an overlap test and SweepBoxes find on fast bullets, by tick rate,
+//                     against a sampled reference, with a marching and a turning invader;
+//                     the run exits with 1 if the swept test misses a reference hit
+//   flaremap_*        a square generated level read with FlareMap style streams and with
+//                     FlareMapParser, per tile and as MB/s of text (median and best repeat)
+//
+// Every timing is the median and minimum over several repeats of a batch sized
+// to run for about 20 ms, with fixed seeds, so runs on the same machine can be
+// compared across commits.
+//
+//   g++ -O2 -std=c++11 -mavx -pthread -I. -I../Common -I../HW3 -I../HW5 Benchmark.cpp EntityStore.cpp SpatialHash.cpp
+//       JobSystem.cpp Hazards.cpp ../Common/SweptCollision.cpp ../Common/HandlePool.cpp ../Common/FlareMapParser.cpp
+//       ../Common/MappedFile.cpp ../HW3/Invaders.cpp ../HW3/CollisionGrid.cpp ../HW5/TileCollision.cpp -o Benchmark
+//   ./Benchmark [--format text|csv|json] [--counts 1000,100000] [--filter hw3] [--repeats 7]
+
+#include "EntityStore.h"
+#include "SpatialHash.h"
+#include "SweptCollision.h"
+#include "HandlePool.h"
+#include "JobSystem.h"
+#include "Hazards.h"
+#include "Invaders.h"
+#include "TileCollision.h"
+#include "FlareMapParser.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// all pairs gets slow fast, larger counts only run the spatial hash
+#define BRUTE_FORCE_LIMIT 20000
+// the stream parser takes over a second for a 4096 x 4096 level
+#define STREAM_PARSE_LIMIT 1024
+// how long one timed batch should take
+#define BATCH_SECONDS 0.02
+
+// same fields and layout as Entity in main.cpp, without the sprite pointer type
+struct AosEntity {
+    float positionX, positionY;
+    float velocityX, velocityY;
+    const void *sprite;
+    float scaleFactor;
+    float width;
+    float height;
+    float timeSinceLastFlap;
+};
+
+struct Result {
+    std::string name;
+    size_t count;
+    // what median and minimum measure, e.g. ns/entity
+    std::string unit;
+    double median;
+    double minimum;
+};
+
+struct Options {
+    std::string format;
+    std::vector<size_t> counts;
+    std::string filter;
+    int repeats;
+};
+
+static Options options;
+static std::vector<Result> results;
+
+// sprites are only compared by address, so any distinct pointers will do
+static const char birdFrames[4] = {0, 0, 0, 0};
+
+static float RandomFloat(float low, float high) {
+    return low + (high - low) * (float)rand() / (float)RAND_MAX;
+}
+
+static double Seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool Selected(const char *name) {
+    return options.filter.empty() || strstr(name, options.filter.c_str()) != NULL;
+}
+
+static std::vector<size_t> Counts(const size_t *defaults, size_t defaultCount) {
+    if (!options.counts.empty()) {
+        return options.counts;
+    }
+    return std::vector<size_t>(defaults, defaults + defaultCount);
+}
+
+static void AddResult(const char *name, size_t count, const char *unit, double median, double minimum) {
+    Result result = {name, count, unit, median, minimum};
+    results.push_back(result);
+    if (options.format == "text") {
+        printf("%-32s %10zu %14.3f %14.3f  %s\n", name, count, median, minimum, unit);
+    }
+}
+
+// Times run, which does `items` units of work, and records nanoseconds per item.
+// setup runs untimed before every batch, for benchmarks that use up their input.
+template <typename F, typename S>
+static void Measure(const char *name, size_t count, size_t items, F run, S setup) {
+    // one untimed pass to warm caches and find how many passes fill a batch
+    setup();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    run();
+    double single = std::max(Seconds(start), 1e-9);
+    int passes = (int)std::max(1.0, std::min(1e6, BATCH_SECONDS / single));
+
+    std::vector<double> samples;
+    for (int repeat = 0; repeat < options.repeats; repeat++) {
+        double total = 0.0;
+        for (int pass = 0; pass < passes; pass++) {
+            setup();
+            start = std::chrono::steady_clock::now();
+            run();
+            total += Seconds(start);
+        }
+        samples.push_back(total * 1e9 / passes / items);
+    }
+    std::sort(samples.begin(), samples.end());
+    AddResult(name, count, "ns/item", samples[samples.size() / 2], samples[0]);
+}
+
+template <typename F>
+static void Measure(const char *name, size_t count, size_t items, F run) {
+    Measure(name, count, items, run, []() {});
+}
+
+static void FillHazards(size_t count, float extent, EntityStore &hazards, std::vector<HazardInfo> &hazardInfo, const BirdSprites &sprites) {
+    hazards.Clear();
+    hazardInfo.clear();
+    for (size_t i = 0; i < count; i++) {
+        HazardInfo info = {i % 2 == 0 ? HAZARD_BOX : HAZARD_BIRD, sprites.bird1, RandomFloat(0.0f, 0.5f)};
+        if (info.kind == HAZARD_BOX) {
+            hazards.Add(RandomFloat(-extent, extent), RandomFloat(-extent, extent), 0.0f, -0.7f, 0.6f, 0.5f);
+        } else {
+            hazards.Add(RandomFloat(-extent, extent), RandomFloat(-extent, extent), 0.3f, -0.4f, 0.42f, 0.35f);
+        }
+        hazardInfo.push_back(info);
+    }
+}
+
+static void BenchmarkIntegrate() {
+    const size_t defaults[] = {1000, 100000, 1000000};
+    const float elapsed = 1.0f / 60.0f;
+    if (!Selected("integrate")) {
+        return;
+    }
+    std::vector<size_t> counts = Counts(defaults, 3);
+    for (size_t c = 0; c < counts.size(); c++) {
+        size_t count = counts[c];
+        srand(1);
+        std::vector<AosEntity> entities(count);
+        EntityStore store;
+        store.Reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            AosEntity entity = {RandomFloat(-1.0f, 1.0f), RandomFloat(-1.8f, 1.8f), RandomFloat(-0.5f, 0.5f), RandomFloat(-0.7f, 0.0f), NULL, 1.0f, 0.6f, 0.5f, 0.0f};
+            entities[i] = entity;
+            store.Add(entity.positionX, entity.positionY, entity.velocityX, entity.velocityY, entity.width, entity.height);
+        }
+
+        if (Selected("integrate_aos")) {
+            Measure("integrate_aos", count, count, [&]() {
+                for (AosEntity &entity: entities) {
+                    entity.positionX += elapsed * entity.velocityX;
+                    entity.positionY += elapsed * entity.velocityY;
+                }
+            });
+        }
+        if (Selected("integrate_soa")) {
+            Measure("integrate_soa", count, count, [&]() { store.IntegrateScalar(elapsed); });
+        }
+        if (Selected("integrate_simd")) {
+            Measure("integrate_simd", count, count, [&]() { store.Integrate(elapsed); });
+        }
+
+        // keeps the optimizer from discarding the updates
+        volatile float sink = entities[count / 2].positionX + store.positionX[count / 2];
+        (void)sink;
+    }
+}
+
+static void BenchmarkUpdateHazards() {
+    const size_t defaults[] = {256, 10000, 100000};
+    if (!Selected("update_hazards")) {
+        return;
+    }
+    BirdSprites sprites = {(const AtlasRegion *)&birdFrames[0], (const AtlasRegion *)&birdFrames[1], (const AtlasRegion *)&birdFrames[2], (const AtlasRegion *)&birdFrames[3]};
+    // no workers, so the number does not depend on the machine's core count
+    JobSystem jobs(0);
+    std::vector<size_t> counts = Counts(defaults, 3);
+    for (size_t c = 0; c < counts.size(); c++) {
+        size_t count = counts[c];
+        srand(4);
+        EntityStore hazards;
+        std::vector<HazardInfo> hazardInfo;
+        FillHazards(count, 0.95f, hazards, hazardInfo, sprites);
+        Measure("update_hazards", count, count, [&]() {
+            hazards.SavePrevious();
+            UpdateHazards(1.0f / 120.0f, hazards, hazardInfo, sprites, jobs);
+        });
+    }
+}
+
+// as the collision phase in main.cpp: rebuild, query around the plane and sweep every candidate
+static void BenchmarkCollidePlane() {
+    const size_t defaults[] = {256, 10000, 100000};
+    if (!Selected("collide_plane")) {
+        return;
+    }
+    BirdSprites sprites = {(const AtlasRegion *)&birdFrames[0], (const AtlasRegion *)&birdFrames[1], (const AtlasRegion *)&birdFrames[2], (const AtlasRegion *)&birdFrames[3]};
+    const float timestep = 1.0f / 120.0f;
+    std::vector<size_t> counts = Counts(defaults, 3);
+    for (size_t c = 0; c < counts.size(); c++) {
+        size_t count = counts[c];
+        float extent = sqrtf((float)count) * 0.5f;
+        srand(5);
+        EntityStore hazards;
+        std::vector<HazardInfo> hazardInfo;
+        FillHazards(count, extent, hazards, hazardInfo, sprites);
+        SpatialHash broadphase(0.5f, std::max((size_t)64, count * 2));
+        std::vector<size_t> candidates;
+        MovingBox plane = {0.0f, 0.0f, 0.48f, 0.4f, 1.5f, 0.0f};
+        volatile int hits = 0;
+        Measure("collide_plane", count, count, [&]() {
+            broadphase.Build(hazards);
+            float reach = 2.0f * timestep * (fabsf(plane.velocityX) + hazards.MaxSpeed());
+            broadphase.Query(plane.x, plane.y, plane.width + reach, plane.height + reach, candidates);
+            MovingBox self = RewoundBox(plane.x - plane.velocityX * timestep, plane.y - plane.velocityY * timestep, plane.x, plane.y, plane.width, plane.height, timestep);
+            for (size_t i: candidates) {
+                MovingBox other = RewoundBox(hazards.previousX[i], hazards.previousY[i], hazards.positionX[i], hazards.positionY[i], hazards.width[i], hazards.height[i], timestep);
+                Impact impact;
+                hits += SweepBoxes(self, other, timestep, impact);
+            }
+        });
+    }
+}
+
+static size_t BruteForcePairs(const EntityStore &store) {
+    size_t pairs = 0;
+    for (size_t a = 0; a < store.Size(); a++) {
+        for (size_t b = a + 1; b < store.Size(); b++) {
+            if (fabsf(store.positionX[a] - store.positionX[b]) < (store.width[a] + store.width[b]) / 2.0f &&
+                fabsf(store.positionY[a] - store.positionY[b]) < (store.height[a] + store.height[b]) / 2.0f) {
+                pairs++;
+            }
+        }
+    }
+    return pairs;
+}
+
+// crate sized boxes spread so the density stays about the same as the count grows
+static void BenchmarkBroadphase() {
+    const size_t defaults[] = {100, 1000, 10000};
+    if (!Selected("broadphase")) {
+        return;
+    }
+    std::vector<size_t> counts = Counts(defaults, 3);
+    for (size_t c = 0; c < counts.size(); c++) {
+        size_t count = counts[c];
+        float extent = sqrtf((float)count) * 0.5f;
+        srand(2);
+        EntityStore store;
+        for (size_t i = 0; i < count; i++) {
+            store.Add(RandomFloat(-extent, extent), RandomFloat(-extent, extent), 0.0f, 0.0f, 0.6f, 0.5f);
+        }
+
+        SpatialHash broadphase(0.5f, count * 2);
+        std::vector<std::pair<size_t, size_t> > pairs;
+        if (count <= BRUTE_FORCE_LIMIT) {
+            size_t expected = BruteForcePairs(store);
+            broadphase.Build(store);
+            broadphase.FindPairs(pairs);
+            if (pairs.size() != expected) {
+                fprintf(stderr, "spatial hash found %zu pairs, expected %zu\n", pairs.size(), expected);
+            }
+            if (Selected("broadphase_brute")) {
+                volatile size_t sink = 0;
+                Measure("broadphase_brute", count, count, [&]() { sink += BruteForcePairs(store); });
+            }
+        }
+        if (Selected("broadphase_hash")) {
+            Measure("broadphase_hash", count, count, [&]() {
+                broadphase.Build(store);
+                broadphase.FindPairs(pairs);
+            });
+        }
+    }
+}
+
+// a full pool emptied by handle in shuffled order, the pattern of hazards leaving the screen at random
+static void BenchmarkSpawnDespawn() {
+    const size_t defaults[] = {256, 10000, 100000};
+    if (!Selected("spawn_despawn")) {
+        return;
+    }
+    std::vector<size_t> counts = Counts(defaults, 3);
+    for (size_t c = 0; c < counts.size(); c++) {
+        size_t count = counts[c];
+        Pool<AosEntity> pool(count);
+        std::vector<Handle> handles(count);
+        std::vector<size_t> order(count);
+        srand(6);
+        for (size_t i = 0; i < count; i++) {
+            order[i] = i;
+        }
+        for (size_t i = count; i-- > 1;) {
+            std::swap(order[i], order[rand() % (i + 1)]);
+        }
+        AosEntity entity = {0.0f, 0.0f, 0.0f, -0.7f, NULL, 1.0f, 0.6f, 0.5f, 0.0f};
+        Measure("spawn_despawn", count, count * 2, [&]() {
+            for (size_t i = 0; i < count; i++) {
+                entity.positionX = (float)i;
+                handles[i] = pool.Spawn(entity);
+            }
+            for (size_t i = 0; i < count; i++) {
+                pool.Despawn(handles[order[i]]);
+            }
+        });
+    }
+}
+
+// the HW3 formation, widened to count invaders in rows of four at the game's spacing
+static void SpawnFormation(Pool<Entity> &invaders, size_t count) {
+    invaders.Clear();
+    int columns = (int)std::max((size_t)1, count / 4);
+    float spacingX = std::min(FORMATION_SPACING_X, 3.0f / columns);
+    for (size_t i = 0; i < count; i++) {
+        invaders.Spawn(Entity(0, -1.5f + (i / 4) * spacingX, 0.6f - (i % 4) * FORMATION_SPACING_Y, 0.3f, 0.0f, 0.15f, 0.20f, 0.02f, 0.02f, 1.5f));
+    }
+}
+
+// count invaders at the game's spacing in a block about as wide as it is tall, so
+// there are as many invaders around a point whatever the count
+static void SpawnBlock(Pool<Entity> &invaders, size_t count) {
+    invaders.Clear();
+    int columns = (int)ceil(sqrt((double)count));
+    for (size_t i = 0; i < count; i++) {
+        invaders.Spawn(Entity(0, -1.5f + (i % columns) * FORMATION_SPACING_X, 0.6f - (i / columns) * FORMATION_SPACING_Y, 0.3f, 0.0f, 0.15f, 0.20f, 0.02f, 0.02f, 1.5f));
+    }
+}
+
+// returns false if a bullet costs much more against the largest formation than the smallest
+static bool BenchmarkHW3() {
+    const size_t defaults[] = {20, 1000, 4096};
+    const float elapsed = 1.0f / 60.0f;
+    // per bullet cost allowed at the largest count, relative to the smallest
+    const double flatLimit = 3.0;
+    if (!Selected("hw3")) {
+        return true;
+    }
+    std::vector<size_t> counts = Counts(defaults, 3);
+    std::vector<double> bulletCosts;
+    for (size_t c = 0; c < counts.size(); c++) {
+        size_t count = counts[c];
+        Pool<Entity> invaders(count);
+        SpawnFormation(invaders, count);
+
+        if (Selected("hw3_march")) {
+            volatile bool reached = false;
+            // the formation bounces between the edges and slowly descends, restart it once it gets low
+            Measure("hw3_march", count, count, [&]() {
+                reached = MarchInvaders(invaders, elapsed, -0.8f);
+            }, [&]() {
+                if (invaders[0].yPos < -0.5f) {
+                    SpawnFormation(invaders, count);
+                }
+            });
+        }
+
+        if (Selected("hw3_grid") || Selected("hw3_bullets")) {
+            // a full pool of bullets spread over the block, refilled before every pass
+            const size_t bulletCount = 64;
+            Pool<Entity> block(count);
+            SpawnBlock(block, count);
+            float right = -1.5f, bottom = 0.6f;
+            for (size_t i = 0; i < block.Size(); i++) {
+                right = std::max(right, block[i].xPos);
+                bottom = std::min(bottom, block[i].yPos);
+            }
+            Pool<Entity> bullets(bulletCount);
+            BulletCollisions collisions;
+            srand(7);
+            std::vector<Entity> volley;
+            for (size_t i = 0; i < bulletCount; i++) {
+                volley.push_back(Entity(0, RandomFloat(-1.6f, right + 0.1f), RandomFloat(bottom - 0.1f, 0.7f), 0.0f, 1.0f, 0.08f, 0.015f, 0.0f, 1.0f, 1.5f));
+            }
+            Pool<Entity> formation = block;
+            if (Selected("hw3_grid")) {
+                Measure("hw3_grid", count, count, [&]() {
+                    collisions.BuildGrid(block);
+                });
+            }
+            if (Selected("hw3_bullets")) {
+                Measure("hw3_bullets", count, bulletCount, [&]() {
+                    collisions.TestBullets(block, bullets, elapsed);
+                }, [&]() {
+                    block = formation;
+                    collisions.BuildGrid(block);
+                    bullets.Clear();
+                    for (size_t i = 0; i < bulletCount; i++) {
+                        bullets.Spawn(volley[i]);
+                    }
+                });
+                bulletCosts.push_back(results.back().median);
+            }
+        }
+    }
+    
+    if (bulletCosts.size() > 1 && bulletCosts.back() > bulletCosts.front() * flatLimit) {
+        fprintf(stderr, "hw3_bullets: %.1f ns per bullet at %zu invaders, %.1f at %zu\n", bulletCosts.back(), counts.back(), bulletCosts.front(), counts.front());
+        return false;
+    }
+    return true;
+}
+
+// a level the width of count tiles with ground, gaps and floating platforms, and one player per column
+static void BenchmarkHW5() {
+    const size_t defaults[] = {100, 1000, 10000};
+    const float tileSize = 0.3f;
+    const float elapsed = 1.0f / 60.0f;
+    if (!Selected("hw5")) {
+        return;
+    }
+    std::vector<size_t> counts = Counts(defaults, 3);
+    for (size_t c = 0; c < counts.size(); c++) {
+        size_t count = counts[c];
+        int mapWidth = (int)std::max((size_t)8, count);
+        int mapHeight = 16;
+        srand(8);
+        std::vector<unsigned int> tiles(mapWidth * mapHeight, 0);
+        std::vector<unsigned int *> rows(mapHeight);
+        for (int y = 0; y < mapHeight; y++) {
+            rows[y] = &tiles[y * mapWidth];
+        }
+        for (int x = 0; x < mapWidth; x++) {
+            if (rand() % 8 != 0) {
+                rows[mapHeight - 1][x] = 1;
+            }
+            if (rand() % 6 == 0) {
+                rows[8 + rand() % 5][x] = 1;
+            }
+        }
+        TileCollision level;
+        level.SetSolid(1);
+        level.Build(&rows[0], mapWidth, mapHeight, tileSize);
+
+        std::vector<float> x(count), y(count), velocityY(count);
+        TileContacts contacts;
+        // everyone starts over at the top of their column once the players run off the level
+        bool restart = true;
+        Measure("hw5_tile_move", count, count, [&]() {
+            for (size_t i = 0; i < count; i++) {
+                velocityY[i] -= 2.5f * elapsed;
+                level.Move(x[i], y[i], 0.12f, 0.15f, 1.5f * elapsed, velocityY[i] * elapsed, contacts);
+                if (contacts.bottom || contacts.top) {
+                    velocityY[i] = contacts.bottom ? 1.5f : 0.0f;
+                }
+            }
+        }, [&]() {
+            if (restart || x[0] > (mapWidth - 2) * tileSize || y[0] < -mapHeight * tileSize) {
+                restart = false;
+                for (size_t i = 0; i < count; i++) {
+                    x[i] = (i % mapWidth) * tileSize;
+                    y[i] = 0.0f;
+                    velocityY[i] = 0.0f;
+                }
+            }
+        });
+    }
+}
+
+// samples per step for the reference, enough that a bullet moves a fraction of an invader's height between samples
+#define TUNNELING_SAMPLES 64
+
+static bool Overlapping(const MovingBox &bullet, const MovingBox &invader) {
+    return fabsf(bullet.x - invader.x) < invader.width / 2.0f && fabsf(bullet.y - invader.y) < invader.height / 2.0f;
+}
+
+// Bullets fired straight up at 8 units a second through an HW3 sized invader marching
+// sideways, stepped the way the games step: integrate, turn the invader around like a bird
+// once it is past turnAt, then test. Counts the hits seen by the end of step overlap test,
+// by the swept test on RewoundBox boxes, and by a reference that samples both along the
+// paths they actually took. Returns false if the swept test missed any reference hit.
+static bool FireBullets(const char *name, int rate, float invaderSpeed, float turnAt) {
+    const int bullets = 1000;
+    float elapsed = 1.0f / rate;
+    int steps = (int)ceilf(0.5f / elapsed);
+    srand(3);
+    int overlapHits = 0;
+    int sweptHits = 0;
+    int expectedHits = 0;
+    for (int i = 0; i < bullets; i++) {
+        MovingBox bullet = {RandomFloat(-0.3f, 0.3f), RandomFloat(-1.2f, -1.0f), 0.0f, 0.0f, 0.0f, 8.0f};
+        MovingBox invader = {RandomFloat(-0.1f, 0.1f), 0.6f, 0.215f, 0.23f, invaderSpeed, 0.0f};
+        bool overlapped = false;
+        bool swept = false;
+        bool expected = Overlapping(bullet, invader);
+        for (int step = 0; step < steps; step++) {
+            MovingBox bulletStart = bullet;
+            MovingBox invaderStart = invader;
+            bullet.x += bullet.velocityX * elapsed;
+            bullet.y += bullet.velocityY * elapsed;
+            invader.x += invader.velocityX * elapsed;
+            if (invader.x >= turnAt) {
+                invader.velocityX = -invader.velocityX;
+            } else if (invader.x <= -turnAt) {
+                invader.velocityX = -invader.velocityX;
+            }
+
+            overlapped = overlapped || Overlapping(bullet, invader);
+            Impact impact;
+            MovingBox bulletBox = RewoundBox(bulletStart.x, bulletStart.y, bullet.x, bullet.y, 0.0f, 0.0f, elapsed);
+            MovingBox invaderBox = RewoundBox(invaderStart.x, invaderStart.y, invader.x, invader.y, invader.width, invader.height, elapsed);
+            swept = swept || SweepBoxes(bulletBox, invaderBox, elapsed, impact);
+            for (int sample = 1; sample <= TUNNELING_SAMPLES && !expected; sample++) {
+                float t = (float)sample / TUNNELING_SAMPLES;
+                MovingBox bulletAt = bullet;
+                MovingBox invaderAt = invader;
+                bulletAt.x = bulletStart.x + (bullet.x - bulletStart.x) * t;
+                bulletAt.y = bulletStart.y + (bullet.y - bulletStart.y) * t;
+                invaderAt.x = invaderStart.x + (invader.x - invaderStart.x) * t;
+                expected = Overlapping(bulletAt, invaderAt);
+            }
+        }
+        overlapHits += overlapped;
+        sweptHits += swept;
+        expectedHits += expected;
+    }
+    char row[64];
+    snprintf(row, sizeof(row), "%s_overlap_%dhz", name, rate);
+    AddResult(row, bullets, "hits", overlapHits, overlapHits);
+    snprintf(row, sizeof(row), "%s_swept_%dhz", name, rate);
+    AddResult(row, bullets, "hits", sweptHits, sweptHits);
+    snprintf(row, sizeof(row), "%s_expected_%dhz", name, rate);
+    AddResult(row, bullets, "hits", expectedHits, expectedHits);
+    if (sweptHits < expectedHits) {
+        fprintf(stderr, "%s at %d Hz: the swept test found %d of %d hits\n", name, rate, sweptHits, expectedHits);
+        return false;
+    }
+    return true;
+}
+
+// an invader marching at HW3's speed, and a bird fast enough to turn around while bullets pass it
+static bool BenchmarkTunneling() {
+    const int rates[] = {10, 30, 60};
+    if (!Selected("tunneling")) {
+        return true;
+    }
+    bool passed = true;
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        passed = FireBullets("tunneling", rates[r], 0.3f, INFINITY) && passed;
+        passed = FireBullets("tunneling_turning", rates[r], 3.0f, 0.2f) && passed;
+    }
+    return passed;
+}
+
+// what FlareMap does with the text: a line at a time, then a string stream per data row
+static void StreamParseFlareMap(const std::string &text, std::vector<unsigned int> &tiles) {
+    std::istringstream infile(text);
+    std::string line;
+    int width = 0, height = 0;
+    while (std::getline(infile, line)) {
+        if (line.compare(0, 6, "width=") == 0) {
+            width = atoi(line.c_str() + 6);
+        } else if (line.compare(0, 7, "height=") == 0) {
+            height = atoi(line.c_str() + 7);
+        } else if (line == "data=") {
+            tiles.resize((size_t)width * height);
+            for (int y = 0; y < height && std::getline(infile, line); y++) {
+                std::istringstream lineStream(line);
+                std::string tile;
+                for (int x = 0; x < width && std::getline(lineStream, tile, ','); x++) {
+                    unsigned int value = (unsigned int)atoi(tile.c_str());
+                    tiles[(size_t)y * width + x] = value > 0 ? value - 1 : 0;
+                }
+            }
+        }
+    }
+}
+
+// adds a MB/s row for the ns/tile result just measured
+static void AddThroughput(const char *name, size_t count, double bytesPerTile) {
+    const Result &timing = results.back();
+    AddResult(name, count, "MB/s", bytesPerTile * 1e3 / timing.median, bytesPerTile * 1e3 / timing.minimum);
+}
+
+static void BenchmarkFlareMap() {
+    const size_t defaults[] = {256, 1024, 4096};
+    if (!Selected("flaremap")) {
+        return;
+    }
+    std::vector<size_t> counts = Counts(defaults, 3);
+    for (size_t c = 0; c < counts.size(); c++) {
+        size_t count = counts[c];
+        size_t tileCount = count * count;
+        std::string text;
+        GenerateFlareMapText((int)count, (int)count, 1, 9, text);
+        double bytesPerTile = (double)text.size() / tileCount;
+
+        if (count <= STREAM_PARSE_LIMIT && Selected("flaremap_stream")) {
+            std::vector<unsigned int> tiles;
+            Measure("flaremap_stream", count, tileCount, [&]() {
+                StreamParseFlareMap(text, tiles);
+            });
+            AddThroughput("flaremap_stream_mbps", count, bytesPerTile);
+        }
+
+        if (Selected("flaremap_parser")) {
+            FlareMapParser parser;
+            Measure("flaremap_parser", count, tileCount, [&]() {
+                parser.Parse(text.data(), text.size(), "generated");
+            });
+            AddThroughput("flaremap_parser_mbps", count, bytesPerTile);
+        }
+    }
+}
+
+static void WriteResults() {
+    if (options.format == "csv") {
+        printf("name,count,unit,median,min\n");
+        for (size_t i = 0; i < results.size(); i++) {
+            printf("%s,%zu,%s,%.4f,%.4f\n", results[i].name.c_str(), results[i].count, results[i].unit.c_str(), results[i].median, results[i].minimum);
+        }
+    } else if (options.format == "json") {
+        printf("{\n  \"repeats\": %d,\n  \"results\": [\n", options.repeats);
+        for (size_t i = 0; i < results.size(); i++) {
+            printf("    {\"name\": \"%s\", \"count\": %zu, \"unit\": \"%s\", \"median\": %.4f, \"min\": %.4f}%s\n", results[i].name.c_str(), results[i].count, results[i].unit.c_str(), results[i].median, results[i].minimum, i + 1 < results.size() ? "," : "");
+        }
+        printf("  ]\n}\n");
+    }
+}
+
+// a whole number above zero with nothing after it
+static bool ParseCount(const char *text, size_t &count) {
+    if (text[0] < '0' || text[0] > '9') {
+        return false;
+    }
+    char *end = NULL;
+    errno = 0;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (*end != '\0' || errno == ERANGE || value == 0) {
+        return false;
+    }
+    count = (size_t)value;
+    return true;
+}
+
+static bool ParseOptions(int argc, char *argv[]) {
+    options.format = "text";
+    options.repeats = 7;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--format") == 0 && hasValue) {
+            options.format = argv[++i];
+        } else if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+            options.filter = argv[++i];
+        } else if (strcmp(argv[i], "--repeats") == 0 && hasValue) {
+            size_t repeats;
+            if (!ParseCount(argv[++i], repeats) || repeats > 1000) {
+                return false;
+            }
+            options.repeats = (int)repeats;
+        } else if (strcmp(argv[i], "--counts") == 0 && hasValue) {
+            // comma separated, one bad entry rejects the whole list
+            std::string list = argv[++i];
+            size_t start = 0;
+            while (true) {
+                size_t comma = list.find(',', start);
+                size_t count;
+                if (!ParseCount(list.substr(start, comma - start).c_str(), count)) {
+                    return false;
+                }
+                options.counts.push_back(count);
+                if (comma == std::string::npos) {
+                    break;
+                }
+                start = comma + 1;
+            }
+        } else {
+            return false;
+        }
+    }
+    return options.format == "text" || options.format == "csv" || options.format == "json";
+}
+
+int main(int argc, char *argv[]) {
+    if (!ParseOptions(argc, argv)) {
+        fprintf(stderr, "usage: Benchmark [--format text|csv|json] [--counts n,n,...] [--filter name] [--repeats n]\n");
+        return 1;
+    }
+    if (options.format == "text") {
+#if defined(__AVX__)
+        printf("SIMD kernel: AVX\n");
+#elif defined(__SSE__) || defined(_M_X64)
+        printf("SIMD kernel: SSE\n");
+#else
+        printf("SIMD kernel: none, scalar fallback\n");
+#endif
+        printf("%-32s %10s %14s %14s\n", "benchmark", "count", "median", "min");
+    }
+
+    BenchmarkIntegrate();
+    BenchmarkUpdateHazards();
+    BenchmarkCollidePlane();
+    BenchmarkBroadphase();
+    BenchmarkSpawnDespawn();
+    bool hw3Passed = BenchmarkHW3();
+    BenchmarkHW5();
+    bool tunnelingPassed = BenchmarkTunneling();
+    BenchmarkFlareMap();
+
+    WriteResults();
+    return hw3Passed && tunnelingPassed ? 0 : 1;
+}
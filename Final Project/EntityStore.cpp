@@ -0,0 +1,123 @@
+#include "EntityStore.h"
+#include <cmath>
+#include <algorithm>
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+	#include <xmmintrin.h>
+	#define ENTITY_STORE_SSE
+#endif
+
+static void IntegrateArray(float *position, const float *velocity, size_t count, float elapsed) {
+    size_t i = 0;
+#if defined(__AVX__)
+    __m256 step = _mm256_set1_ps(elapsed);
+    for (; i + 8 <= count; i += 8) {
+        __m256 p = _mm256_loadu_ps(position + i);
+        __m256 v = _mm256_loadu_ps(velocity + i);
+        _mm256_storeu_ps(position + i, _mm256_add_ps(p, _mm256_mul_ps(v, step)));
+    }
+#elif defined(ENTITY_STORE_SSE)
+    __m128 step = _mm_set1_ps(elapsed);
+    for (; i + 4 <= count; i += 4) {
+        __m128 p = _mm_loadu_ps(position + i);
+        __m128 v = _mm_loadu_ps(velocity + i);
+        _mm_storeu_ps(position + i, _mm_add_ps(p, _mm_mul_ps(v, step)));
+    }
+#endif
+    // leftovers, or everything on targets without SSE
+    for (; i < count; i++) {
+        position[i] += velocity[i] * elapsed;
+    }
+}
+
+void EntityStore::Reserve(size_t capacity) {
+    positionX.reserve(capacity);
+    positionY.reserve(capacity);
+    velocityX.reserve(capacity);
+    velocityY.reserve(capacity);
+    width.reserve(capacity);
+    height.reserve(capacity);
+    previousX.reserve(capacity);
+    previousY.reserve(capacity);
+}
+
+size_t EntityStore::Add(float x, float y, float velocityX, float velocityY, float width, float height) {
+    positionX.push_back(x);
+    positionY.push_back(y);
+    this->velocityX.push_back(velocityX);
+    this->velocityY.push_back(velocityY);
+    this->width.push_back(width);
+    this->height.push_back(height);
+    previousX.push_back(x);
+    previousY.push_back(y);
+    return positionX.size() - 1;
+}
+
+void EntityStore::Remove(size_t index) {
+    size_t last = positionX.size() - 1;
+    positionX[index] = positionX[last];
+    positionY[index] = positionY[last];
+    velocityX[index] = velocityX[last];
+    velocityY[index] = velocityY[last];
+    width[index] = width[last];
+    height[index] = height[last];
+    previousX[index] = previousX[last];
+    previousY[index] = previousY[last];
+    positionX.pop_back();
+    positionY.pop_back();
+    velocityX.pop_back();
+    velocityY.pop_back();
+    width.pop_back();
+    height.pop_back();
+    previousX.pop_back();
+    previousY.pop_back();
+}
+
+void EntityStore::Clear() {
+    positionX.clear();
+    positionY.clear();
+    velocityX.clear();
+    velocityY.clear();
+    width.clear();
+    height.clear();
+    previousX.clear();
+    previousY.clear();
+}
+
+size_t EntityStore::Size() const {
+    return positionX.size();
+}
+
+void EntityStore::Integrate(float elapsed) {
+    Integrate(elapsed, 0, positionX.size());
+}
+
+void EntityStore::Integrate(float elapsed, size_t begin, size_t end) {
+    if (begin >= end) {
+        return;
+    }
+    IntegrateArray(&positionX[begin], &velocityX[begin], end - begin, elapsed);
+    IntegrateArray(&positionY[begin], &velocityY[begin], end - begin, elapsed);
+}
+
+float EntityStore::MaxSpeed() const {
+    float speed = 0.0f;
+    for (size_t i = 0; i < velocityX.size(); i++) {
+        speed = std::max(speed, std::max(fabsf(velocityX[i]), fabsf(velocityY[i])));
+    }
+    return speed;
+}
+
+void EntityStore::SavePrevious() {
+    previousX.assign(positionX.begin(), positionX.end());
+    previousY.assign(positionY.begin(), positionY.end());
+}
+
+void EntityStore::IntegrateScalar(float elapsed) {
+    for (size_t i = 0; i < positionX.size(); i++) {
+        positionX[i] += velocityX[i] * elapsed;
+        positionY[i] += velocityY[i] * elapsed;
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// Structure-of-arrays storage for moving entities. Each hot field lives in its
+// own contiguous array so integration streams through memory and vectorizes.
+// Per-entity data that the update loop does not touch (sprites, animation
+// timers) is kept by the owner in a parallel array, indexed the same way.
+class EntityStore {
+    public:
+
+        void Reserve(size_t capacity);
+        size_t Add(float x, float y, float velocityX, float velocityY, float width, float height);
+        // moves the last entity into index, so the owner has to mirror the swap
+        void Remove(size_t index);
+        void Clear();
+        size_t Size() const;
+
+        // position += velocity * elapsed for every entity, using AVX or SSE when available
+        void Integrate(float elapsed);
+        // the same for entities [begin, end) only, so ranges can run on different threads
+        void Integrate(float elapsed, size_t begin, size_t end);
+        // plain loop with the same result, kept as a reference for the benchmark
+        void IntegrateScalar(float elapsed);
+        // largest speed along either axis, for growing query boxes by how far anything can move in a step
+        float MaxSpeed() const;
+        // copies positions into previousX and previousY before a simulation step
+        void SavePrevious();
+
+        std::vector<float> positionX;
+        std::vector<float> positionY;
+        std::vector<float> velocityX;
+        std::vector<float> velocityY;
+        std::vector<float> width;
+        std::vector<float> height;
+        // positions before the last step, drawing blends towards positionX and positionY
+        std::vector<float> previousX;
+        std::vector<float> previousY;
+};
@@ -0,0 +1,49 @@
+#include "Hazards.h"
+
+// a multiple of 8 so every chunk but the last runs entirely in the SIMD loop
+#define HAZARD_UPDATE_GRAIN 4096
+
+static void UpdateBirds(float elapsed, EntityStore &hazards, std::vector<HazardInfo> &hazardInfo, const BirdSprites &sprites, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        HazardInfo &bird = hazardInfo[i];
+        if (bird.kind != HAZARD_BIRD) {
+            continue;
+        }
+        float &velocityX = hazards.velocityX[i];
+        bird.timeSinceLastFlap += elapsed;
+        // switch direction of bird if it hits edges of screen
+        if (hazards.positionX[i] >= 0.95) {
+            velocityX = -velocityX;
+            bird.sprite = sprites.birdR1;
+        }
+        else if (hazards.positionX[i] <= -0.95) {
+            velocityX = -velocityX;
+            bird.sprite = sprites.bird1;
+        }
+        if (bird.timeSinceLastFlap > 0.5f && velocityX > 0.0f) {
+            bird.sprite = bird.sprite == sprites.bird1 ? sprites.bird2 : sprites.bird1;
+            bird.timeSinceLastFlap = 0.0;
+        }
+        else if (bird.timeSinceLastFlap > 0.5f && velocityX < 0.0f) {
+            bird.sprite = bird.sprite == sprites.birdR1 ? sprites.birdR2 : sprites.birdR1;
+            bird.timeSinceLastFlap = 0.0;
+        }
+    }
+}
+
+int BirdFrame(const BirdSprites &sprites, const AtlasRegion *sprite) {
+    const AtlasRegion *frames[4] = {sprites.bird1, sprites.bird2, sprites.birdR1, sprites.birdR2};
+    for (int i = 0; i < 4; i++) {
+        if (sprite == frames[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void UpdateHazards(float elapsed, EntityStore &hazards, std::vector<HazardInfo> &hazardInfo, const BirdSprites &sprites, JobSystem &jobs) {
+    jobs.ParallelFor(hazards.Size(), HAZARD_UPDATE_GRAIN, [&](size_t begin, size_t end) {
+        hazards.Integrate(elapsed, begin, end);
+        UpdateBirds(elapsed, hazards, hazardInfo, sprites, begin, end);
+    });
+}
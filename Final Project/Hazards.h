@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+#include "EntityStore.h"
+#include "JobSystem.h"
+
+struct AtlasRegion;
+
+enum HazardKind {HAZARD_BOX, HAZARD_BIRD};
+
+// the parts of a crate or bird the integration loop never reads
+struct HazardInfo {
+    HazardKind kind;
+    const AtlasRegion *sprite;
+    float timeSinceLastFlap;
+};
+
+// flap frames for birds flying right (bird1, bird2) and left (birdR1, birdR2)
+struct BirdSprites {
+    const AtlasRegion *bird1;
+    const AtlasRegion *bird2;
+    const AtlasRegion *birdR1;
+    const AtlasRegion *birdR2;
+};
+
+// 0 to 3 for bird1, bird2, birdR1 and birdR2 and -1 for any other sprite, an id for
+// the frame that stays the same however the sprites were packed or loaded
+int BirdFrame(const BirdSprites &sprites, const AtlasRegion *sprite);
+
+// Moves every crate and bird by elapsed, turns birds around at the screen edges
+// and flaps their wings. Each hazard only reads and writes its own index, so
+// ranges run on the job threads with the same result as one loop.
+void UpdateHazards(float elapsed, EntityStore &hazards, std::vector<HazardInfo> &hazardInfo, const BirdSprites &sprites, JobSystem &jobs);
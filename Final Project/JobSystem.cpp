@@ -0,0 +1,134 @@
+#include "JobSystem.h"
+#include <algorithm>
+
+JobSystem::JobSystem(int workerCount): generation(0), quit(false), remaining(0), jobFunction(NULL), jobData(NULL), jobCount(0), jobGrain(1) {
+    if (workerCount < 0) {
+        unsigned int cores = std::thread::hardware_concurrency();
+        workerCount = cores > 1 ? (int)cores - 1 : 0;
+    }
+    for (int i = 0; i <= workerCount; i++) {
+        queues.push_back(new Queue());
+        queues.back()->front = queues.back()->back = 0;
+    }
+    for (int i = 1; i <= workerCount; i++) {
+        workers.push_back(std::thread(&JobSystem::WorkerMain, this, i));
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> guard(wakeLock);
+        quit = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    for (size_t i = 0; i < queues.size(); i++) {
+        delete queues[i];
+    }
+}
+
+size_t JobSystem::ChunkCount(size_t count, size_t grainSize) {
+    if (grainSize == 0) {
+        grainSize = 1;
+    }
+    return (count + grainSize - 1) / grainSize;
+}
+
+int JobSystem::ThreadCount() const {
+    return (int)queues.size();
+}
+
+void JobSystem::Run(size_t count, size_t grainSize, JobFunction function, const void *job) {
+    if (grainSize == 0) {
+        grainSize = 1;
+    }
+    size_t chunkCount = ChunkCount(count, grainSize);
+    if (chunkCount == 0) {
+        return;
+    }
+    // not worth waking anyone for
+    if (workers.empty() || chunkCount == 1) {
+        for (size_t begin = 0; begin < count; begin += grainSize) {
+            function(job, begin, std::min(begin + grainSize, count));
+        }
+        return;
+    }
+
+    jobFunction = function;
+    jobData = job;
+    jobCount = count;
+    jobGrain = grainSize;
+    remaining = chunkCount;
+    // hand each thread a contiguous run of chunks, neighbouring chunks tend to share cache lines
+    size_t threads = queues.size();
+    for (size_t t = 0; t < threads; t++) {
+        std::lock_guard<std::mutex> guard(queues[t]->lock);
+        queues[t]->front = chunkCount * t / threads;
+        queues[t]->back = chunkCount * (t + 1) / threads;
+    }
+    {
+        std::lock_guard<std::mutex> guard(wakeLock);
+        generation++;
+    }
+    wake.notify_all();
+
+    RunChunks(0);
+
+    // job lives on the caller's stack, so wait for chunks other threads are still running
+    std::unique_lock<std::mutex> guard(doneLock);
+    while (remaining > 0) {
+        done.wait(guard);
+    }
+}
+
+bool JobSystem::PopChunk(int index, size_t &chunk) {
+    Queue &own = *queues[index];
+    {
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (own.front < own.back) {
+            chunk = own.front++;
+            return true;
+        }
+    }
+    // steal from the far end of someone else's run
+    for (size_t offset = 1; offset < queues.size(); offset++) {
+        Queue &other = *queues[(index + offset) % queues.size()];
+        std::lock_guard<std::mutex> guard(other.lock);
+        if (other.front < other.back) {
+            chunk = --other.back;
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::RunChunks(int index) {
+    size_t chunk;
+    while (PopChunk(index, chunk)) {
+        size_t begin = chunk * jobGrain;
+        jobFunction(jobData, begin, std::min(begin + jobGrain, jobCount));
+        if (remaining.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> guard(doneLock);
+            done.notify_one();
+        }
+    }
+}
+
+void JobSystem::WorkerMain(int index) {
+    unsigned int seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> guard(wakeLock);
+            while (!quit && generation == seen) {
+                wake.wait(guard);
+            }
+            if (quit) {
+                return;
+            }
+            seen = generation;
+        }
+        RunChunks(index);
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+
+// A fixed set of worker threads running parallel-for loops. Each thread, the
+// caller included, owns a queue of chunks. It works through its own queue from
+// the front and steals from the back of the others once it runs dry, so uneven
+// chunks still keep every core busy.
+//
+// Chunk boundaries depend only on the count and grain size, never on the
+// number of workers. A job that writes each index or chunk to its own output
+// slot therefore gives the same result on any machine.
+class JobSystem {
+    public:
+
+        // workerCount extra threads besides the caller, -1 picks one per remaining core
+        JobSystem(int workerCount = -1);
+        ~JobSystem();
+
+        // calls job(begin, end) over [0, count) in chunks of grainSize and returns once all of them finished.
+        // job is called through a pointer rather than copied into a std::function, so nothing allocates
+        template <typename F>
+        void ParallelFor(size_t count, size_t grainSize, const F &job) {
+            Run(count, grainSize, &CallJob<F>, &job);
+        }
+
+        // chunks ParallelFor splits count into, chunk c covers [c * grainSize, (c + 1) * grainSize)
+        static size_t ChunkCount(size_t count, size_t grainSize);
+
+        int ThreadCount() const;
+
+    private:
+
+        typedef void (*JobFunction)(const void *job, size_t begin, size_t end);
+
+        template <typename F>
+        static void CallJob(const void *job, size_t begin, size_t end) {
+            (*(const F *)job)(begin, end);
+        }
+
+        // a thread's run of chunks, taken from the front by its owner and from the back by thieves
+        struct Queue {
+            std::mutex lock;
+            size_t front;
+            size_t back;
+        };
+
+        void Run(size_t count, size_t grainSize, JobFunction function, const void *job);
+
+        void WorkerMain(int index);
+        bool PopChunk(int index, size_t &chunk);
+        // runs chunks until every queue is empty
+        void RunChunks(int index);
+
+        std::vector<std::thread> workers;
+        // queue 0 belongs to the calling thread
+        std::vector<Queue *> queues;
+
+        std::mutex wakeLock;
+        std::condition_variable wake;
+        unsigned int generation;
+        bool quit;
+
+        std::mutex doneLock;
+        std::condition_variable done;
+        std::atomic<size_t> remaining;
+
+        // the loop being run, only changed while no chunks are left
+        JobFunction jobFunction;
+        const void *jobData;
+        size_t jobCount;
+        size_t jobGrain;
+};
@@ -0,0 +1,230 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <iostream>
+
+static std::atomic<unsigned long> allocationCount(0);
+
+#ifdef PROFILE_ALLOCATIONS
+// count every heap allocation in the program for the overlay, only in builds that ask for it
+// since it replaces the allocator for the whole program
+void *operator new(size_t size) {
+    allocationCount++;
+    void *memory = malloc(size ? size : 1);
+    if (memory == NULL) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    free(memory);
+}
+#endif
+
+static const char *phaseNames[PHASE_COUNT] = {"events", "update", "collide", "draw", "swap"};
+
+static float TicksToMilliseconds(Uint64 ticks) {
+    return (float)((double)ticks * 1000.0 / (double)SDL_GetPerformanceFrequency());
+}
+
+RollingSamples::RollingSamples(): count(0), next(0) {}
+
+void RollingSamples::Add(float value) {
+    values[next] = value;
+    next = (next + 1) % PROFILE_WINDOW;
+    if (count < PROFILE_WINDOW) {
+        count++;
+    }
+}
+
+float RollingSamples::Average() const {
+    if (count == 0) {
+        return 0.0f;
+    }
+    float total = 0.0f;
+    for (int i = 0; i < count; i++) {
+        total += values[i];
+    }
+    return total / count;
+}
+
+float RollingSamples::Percentile(float percentile) const {
+    if (count == 0) {
+        return 0.0f;
+    }
+    float sorted[PROFILE_WINDOW];
+    std::copy(values, values + count, sorted);
+    int index = std::min(count - 1, (int)(percentile * (count - 1)));
+    std::nth_element(sorted, sorted + index, sorted + count);
+    return sorted[index];
+}
+
+Profiler::Profiler(): visible(false), drawCalls(0), entityCount(0), vertexCount(0), bindsUnsorted(0), bindsSorted(0),
+    programSwitchesUnsorted(0), programSwitchesSorted(0), glCallsIssued(0), glCallsAvoided(0), frameStart(0), frameAllocations(0), hasTimerQueries(false), frameIndex(0), timeSinceOverlayUpdate(0.0f) {
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        phaseStart[phase] = 0;
+        phaseTicks[phase] = 0;
+        phaseEntered[phase] = false;
+        timingGpu[phase] = false;
+        for (int slot = 0; slot < PROFILE_QUERY_LATENCY; slot++) {
+            queries[slot][phase] = 0;
+            queryPending[slot][phase] = false;
+        }
+    }
+}
+
+void Profiler::Load(const AtlasRegion &font) {
+    // timer queries need GL 3.3, ARB_timer_query or EXT_timer_query
+    const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+    const char *version = (const char *)glGetString(GL_VERSION);
+    hasTimerQueries = (version != NULL && atof(version) >= 3.3) ||
+        (extensions != NULL && (strstr(extensions, "GL_ARB_timer_query") != NULL || strstr(extensions, "GL_EXT_timer_query") != NULL));
+    if (hasTimerQueries) {
+        glGenQueries(PROFILE_QUERY_LATENCY * PHASE_COUNT, &queries[0][0]);
+    }
+    for (int i = 0; i < PROFILE_OVERLAY_LINES; i++) {
+        lines[i].Setup(font, 0.07f, -0.03f);
+    }
+}
+
+void Profiler::Cleanup() {
+    if (hasTimerQueries) {
+        glDeleteQueries(PROFILE_QUERY_LATENCY * PHASE_COUNT, &queries[0][0]);
+    }
+    for (int i = 0; i < PROFILE_OVERLAY_LINES; i++) {
+        lines[i].Cleanup();
+    }
+}
+
+void Profiler::ReadQueries(int slot) {
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        if (!queryPending[slot][phase]) {
+            continue;
+        }
+        GLint available = 0;
+        glGetQueryObjectiv(queries[slot][phase], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            continue;
+        }
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(queries[slot][phase], GL_QUERY_RESULT, &nanoseconds);
+        gpuPhases[phase].Add((float)(nanoseconds / 1000000.0));
+        queryPending[slot][phase] = false;
+    }
+}
+
+void Profiler::BeginFrame() {
+    frameStart = SDL_GetPerformanceCounter();
+    frameAllocations = allocationCount;
+    if (hasTimerQueries) {
+        // results from PROFILE_QUERY_LATENCY frames ago are normally ready by now
+        ReadQueries(frameIndex % PROFILE_QUERY_LATENCY);
+    }
+}
+
+void Profiler::EndFrame() {
+    Uint64 now = SDL_GetPerformanceCounter();
+    float frameMilliseconds = TicksToMilliseconds(now - frameStart);
+    cpuFrame.Add(frameMilliseconds);
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        if (phaseEntered[phase]) {
+            cpuPhases[phase].Add(TicksToMilliseconds(phaseTicks[phase]));
+            phaseTicks[phase] = 0;
+            phaseEntered[phase] = false;
+        }
+    }
+    allocations.Add((float)(allocationCount - frameAllocations));
+    frameIndex++;
+    
+    timeSinceOverlayUpdate += frameMilliseconds / 1000.0f;
+}
+
+void Profiler::BeginPhase(ProfilePhase phase) {
+    phaseStart[phase] = SDL_GetPerformanceCounter();
+    
+    // a query still waiting on the GPU is skipped rather than waited for
+    int slot = frameIndex % PROFILE_QUERY_LATENCY;
+    timingGpu[phase] = hasTimerQueries && !queryPending[slot][phase];
+    if (timingGpu[phase]) {
+        glBeginQuery(GL_TIME_ELAPSED, queries[slot][phase]);
+    }
+}
+
+void Profiler::EndPhase(ProfilePhase phase) {
+    if (timingGpu[phase]) {
+        glEndQuery(GL_TIME_ELAPSED);
+        queryPending[frameIndex % PROFILE_QUERY_LATENCY][phase] = true;
+        timingGpu[phase] = false;
+    }
+    phaseTicks[phase] += SDL_GetPerformanceCounter() - phaseStart[phase];
+    phaseEntered[phase] = true;
+}
+
+void Profiler::UpdateOverlay() {
+    char line[96];
+    snprintf(line, sizeof(line), "frame %.2fms p50 %.2f p95 %.2f p99 %.2f", cpuFrame.Average(), cpuFrame.Percentile(0.5f), cpuFrame.Percentile(0.95f), cpuFrame.Percentile(0.99f));
+    lines[0].SetText(line);
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        snprintf(line, sizeof(line), "%-8s cpu %.2f p95 %.2f gpu %.2f", phaseNames[phase], cpuPhases[phase].Average(), cpuPhases[phase].Percentile(0.95f), gpuPhases[phase].Average());
+        lines[phase + 1].SetText(line);
+    }
+#ifdef PROFILE_ALLOCATIONS
+    snprintf(line, sizeof(line), "draws %d entities %d allocs %.0f", drawCalls, entityCount, allocations.Average());
+#else
+    snprintf(line, sizeof(line), "draws %d entities %d", drawCalls, entityCount);
+#endif
+    lines[PHASE_COUNT + 1].SetText(line);
+    snprintf(line, sizeof(line), "verts %d binds %d>%d programs %d>%d gl %d skip %d", vertexCount, bindsUnsorted, bindsSorted,
+             programSwitchesUnsorted, programSwitchesSorted, glCallsIssued, glCallsAvoided);
+    lines[PHASE_COUNT + 2].SetText(line);
+}
+
+void Profiler::DrawOverlay(RenderQueue &queue, ShaderProgram &program) {
+    if (!visible) {
+        return;
+    }
+    // rebuilding the labels every frame would be unreadable and cost uploads
+    if (timeSinceOverlayUpdate > 0.25f) {
+        UpdateOverlay();
+        timeSinceOverlayUpdate = 0.0f;
+    }
+    for (int i = 0; i < PROFILE_OVERLAY_LINES; i++) {
+        queue.SubmitText(LAYER_TEXT, program, lines[i], -0.95f, 1.7f - i * 0.08f);
+    }
+}
+
+void Profiler::Report() {
+    std::cout << "frame cpu mean " << cpuFrame.Average() << " ms p50 " << cpuFrame.Percentile(0.5f) << " p95 " << cpuFrame.Percentile(0.95f) << " p99 " << cpuFrame.Percentile(0.99f) << std::endl;
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        std::cout << "  " << phaseNames[phase] << ": cpu mean " << cpuPhases[phase].Average() << " ms p95 " << cpuPhases[phase].Percentile(0.95f);
+        if (hasTimerQueries) {
+            std::cout << " gpu mean " << gpuPhases[phase].Average() << " ms";
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "  draws " << drawCalls << " entities " << entityCount;
+#ifdef PROFILE_ALLOCATIONS
+    std::cout << " allocations/frame " << allocations.Average();
+#endif
+    std::cout << std::endl;
+    std::cout << "  last frame: vertices " << vertexCount << " texture binds " << bindsUnsorted << " -> " << bindsSorted;
+    std::cout << " program switches " << programSwitchesUnsorted << " -> " << programSwitchesSorted;
+    std::cout << " gl program/uniform calls issued " << glCallsIssued << " avoided " << glCallsAvoided << std::endl;
+}
+
+unsigned long Profiler::AllocationCount() {
+    return allocationCount;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL.h>
+#include <SDL_opengl.h>
+#include "ShaderProgram.h"
+#include "TextRenderer.h"
+#include "RenderQueue.h"
+
+// the legacy macOS context only exposes timer queries through EXT_timer_query
+#ifdef __APPLE__
+	#define glGetQueryObjectui64v glGetQueryObjectui64vEXT
+	#ifndef GL_TIME_ELAPSED
+		#define GL_TIME_ELAPSED GL_TIME_ELAPSED_EXT
+	#endif
+#endif
+
+enum ProfilePhase {PHASE_EVENTS, PHASE_UPDATE, PHASE_COLLISION, PHASE_DRAW, PHASE_SWAP, PHASE_COUNT};
+
+// samples kept per phase for the rolling statistics
+#define PROFILE_WINDOW 120
+// frames a timer query gets before it is read back, so reading never stalls
+#define PROFILE_QUERY_LATENCY 4
+// frame line, one line per phase, then the counter lines
+#define PROFILE_OVERLAY_LINES (PHASE_COUNT + 3)
+
+struct RollingSamples {
+    float values[PROFILE_WINDOW];
+    int count;
+    int next;
+    
+    RollingSamples();
+    void Add(float value);
+    float Average() const;
+    float Percentile(float percentile) const;
+};
+
+// CPU and GPU timings for each phase of the frame loop plus a few per-frame counters,
+// shown as a text overlay or printed at the end of a headless run.
+class Profiler {
+    public:
+    
+        Profiler();
+    
+        void Load(const AtlasRegion &font);
+        void Cleanup();
+    
+        void BeginFrame();
+        void EndFrame();
+        // a phase entered several times in a frame, once per simulation step, counts as one sample
+        void BeginPhase(ProfilePhase phase);
+        void EndPhase(ProfilePhase phase);
+    
+        void DrawOverlay(RenderQueue &queue, ShaderProgram &program);
+        void Report();
+    
+        bool visible;
+    
+        // filled in by the game each frame
+        int drawCalls;
+        int entityCount;
+        int vertexCount;
+        // texture binds and program switches in submission order and after sorting
+        int bindsUnsorted;
+        int bindsSorted;
+        int programSwitchesUnsorted;
+        int programSwitchesSorted;
+        // glUseProgram/glUniform calls issued and skipped by ShaderProgram
+        int glCallsIssued;
+        int glCallsAvoided;
+    
+        RollingSamples cpuFrame;
+        RollingSamples cpuPhases[PHASE_COUNT];
+        RollingSamples gpuPhases[PHASE_COUNT];
+        RollingSamples allocations;
+    
+        // heap allocations made through operator new since startup, always 0 unless built with PROFILE_ALLOCATIONS
+        static unsigned long AllocationCount();
+    
+    private:
+    
+        void ReadQueries(int slot);
+        void UpdateOverlay();
+    
+        Uint64 frameStart;
+        Uint64 phaseStart[PHASE_COUNT];
+        Uint64 phaseTicks[PHASE_COUNT];
+        bool phaseEntered[PHASE_COUNT];
+        unsigned long frameAllocations;
+    
+        GLuint queries[PROFILE_QUERY_LATENCY][PHASE_COUNT];
+        bool queryPending[PROFILE_QUERY_LATENCY][PHASE_COUNT];
+        bool timingGpu[PHASE_COUNT];
+        bool hasTimerQueries;
+        int frameIndex;
+    
+        float timeSinceOverlayUpdate;
+        TextLabel lines[PROFILE_OVERLAY_LINES];
+};
+
+// Times the enclosing block as one phase.
+class ProfileScope {
+    public:
+        ProfileScope(Profiler &profiler, ProfilePhase phase): profiler(profiler), phase(phase) {
+            profiler.BeginPhase(phase);
+        }
+        ~ProfileScope() {
+            profiler.EndPhase(phase);
+        }
+    private:
+        Profiler &profiler;
+        ProfilePhase phase;
+};
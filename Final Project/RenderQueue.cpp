@@ -0,0 +1,105 @@
+#include "RenderQueue.h"
+#include <algorithm>
+
+static bool CompareCommands(const RenderCommand &a, const RenderCommand &b) {
+    return a.key < b.key;
+}
+
+RenderQueue::RenderQueue(): drawCalls(0), bindsUnsorted(0), bindsSorted(0), programSwitchesUnsorted(0), programSwitchesSorted(0) {
+    commands.reserve(1024);
+}
+
+void RenderQueue::Clear() {
+    commands.clear();
+}
+
+uint64_t RenderQueue::MakeKey(unsigned int layer, unsigned int shader, unsigned int texture, float depth, unsigned int sequence) {
+    depth = std::min(std::max(depth, 0.0f), 1.0f);
+    uint64_t depthBits = (uint64_t)(depth * 65535.0f);
+    return ((uint64_t)(layer & 0xFF) << 56) |
+           ((uint64_t)(shader & 0xFF) << 48) |
+           ((uint64_t)(texture & 0xFFFF) << 32) |
+           (depthBits << 16) |
+           (uint64_t)std::min(sequence, 0xFFFFu);
+}
+
+void RenderQueue::SubmitQuad(RenderLayer layer, ShaderProgram &program, GLuint texture, float depth, float x, float y, float width, float height, float u0, float v0, float u1, float v1) {
+    RenderCommand command;
+    command.key = MakeKey(layer, program.programID, texture, depth, (unsigned int)commands.size());
+    command.program = &program;
+    command.texture = texture;
+    command.x = x;
+    command.y = y;
+    command.width = width;
+    command.height = height;
+    command.u0 = u0;
+    command.v0 = v0;
+    command.u1 = u1;
+    command.v1 = v1;
+    command.label = NULL;
+    commands.push_back(command);
+}
+
+void RenderQueue::SubmitText(RenderLayer layer, ShaderProgram &program, TextLabel &label, float x, float y) {
+    RenderCommand command;
+    command.key = MakeKey(layer, program.programID, label.font.texture, 1.0f, (unsigned int)commands.size());
+    command.program = &program;
+    command.texture = label.font.texture;
+    command.x = x;
+    command.y = y;
+    command.label = &label;
+    commands.push_back(command);
+}
+
+void RenderQueue::CountStateChanges(int &binds, int &programSwitches) const {
+    binds = 0;
+    programSwitches = 0;
+    GLuint texture = 0;
+    ShaderProgram *program = NULL;
+    for (size_t i = 0; i < commands.size(); i++) {
+        if (commands[i].texture != texture) {
+            texture = commands[i].texture;
+            binds++;
+        }
+        if (commands[i].program != program) {
+            program = commands[i].program;
+            programSwitches++;
+        }
+    }
+}
+
+void RenderQueue::Execute(SpriteBatch &batch) {
+    CountStateChanges(bindsUnsorted, programSwitchesUnsorted);
+    std::stable_sort(commands.begin(), commands.end(), CompareCommands);
+    CountStateChanges(bindsSorted, programSwitchesSorted);
+    
+    // adjacent quads with the same program are merged into one batch run,
+    // the batch itself only flushes when the texture changes
+    ShaderProgram *batchProgram = NULL;
+    int batchDrawCalls = batch.drawCalls;
+    drawCalls = 0;
+    for (size_t i = 0; i < commands.size(); i++) {
+        RenderCommand &command = commands[i];
+        if (command.label != NULL) {
+            if (batchProgram != NULL) {
+                batch.End();
+                batchProgram = NULL;
+            }
+            command.label->Draw(*command.program, command.x, command.y);
+            drawCalls++;
+            continue;
+        }
+        if (command.program != batchProgram) {
+            if (batchProgram != NULL) {
+                batch.End();
+            }
+            batchProgram = command.program;
+            batch.Begin(*batchProgram);
+        }
+        batch.DrawQuad(command.texture, command.x, command.y, command.width, command.height, command.u0, command.v0, command.u1, command.v1);
+    }
+    if (batchProgram != NULL) {
+        batch.End();
+    }
+    drawCalls += batch.drawCalls - batchDrawCalls;
+}
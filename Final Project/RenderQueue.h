@@ -0,0 +1,65 @@
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+#include <stdint.h>
+#include <vector>
+#include "ShaderProgram.h"
+#include "SpriteBatch.h"
+#include "TextRenderer.h"
+
+// draw order between groups of commands, lowest first. The sprites blend, so
+// everything that overlaps on screen needs its own layer in painter's order,
+// within a layer commands are grouped by texture
+enum RenderLayer {LAYER_CLOUDS, LAYER_HAZARDS, LAYER_PLANE, LAYER_EFFECTS, LAYER_UI, LAYER_TEXT};
+
+struct RenderCommand {
+    // layer:8 | shader:8 | texture:16 | depth:16 | submission order:16 (saturates at 65535)
+    uint64_t key;
+    ShaderProgram *program;
+    GLuint texture;
+    float x, y, width, height;
+    float u0, v0, u1, v1;
+    // when set the command draws this label at (x, y) instead of a quad
+    TextLabel *label;
+};
+
+// Game code submits draws in any order during the frame, Execute() sorts them
+// by key so commands sharing a program and texture end up next to each other
+// and go through the SpriteBatch as one run. The sort is stable, commands with
+// equal keys keep their submission order.
+class RenderQueue {
+    public:
+    
+        RenderQueue();
+    
+        void Clear();
+    
+        // depth runs from 0 (back) to 1 (front) among quads sharing a layer and texture
+        void SubmitQuad(RenderLayer layer, ShaderProgram &program, GLuint texture, float depth,
+                        float x, float y, float width, float height,
+                        float u0 = 0.0f, float v0 = 0.0f, float u1 = 1.0f, float v1 = 1.0f);
+        void SubmitText(RenderLayer layer, ShaderProgram &program, TextLabel &label, float x, float y);
+    
+        void Execute(SpriteBatch &batch);
+    
+        static uint64_t MakeKey(unsigned int layer, unsigned int shader, unsigned int texture, float depth, unsigned int sequence);
+    
+        std::vector<RenderCommand> commands;
+    
+        // draw calls issued by the last Execute, batched runs plus text labels
+        int drawCalls;
+    
+        // texture binds and program switches the last frame would have needed in
+        // submission order, and what it needed after sorting
+        int bindsUnsorted;
+        int bindsSorted;
+        int programSwitchesUnsorted;
+        int programSwitchesSorted;
+    
+    private:
+    
+        void CountStateChanges(int &binds, int &programSwitches) const;
+};
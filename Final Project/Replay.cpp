@@ -0,0 +1,210 @@
+#include "Replay.h"
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+
+#define REPLAY_MAGIC "PGRP"
+#define REPLAY_VERSION 1
+
+Random::Random(unsigned int seed) {
+    Seed(seed);
+}
+
+void Random::Seed(unsigned int seed) {
+    // xorshift never leaves zero
+    state = seed != 0 ? seed : 0x9E3779B9u;
+}
+
+unsigned int Random::Next() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+int Random::Range(int range) {
+    return (int)(Next() % (unsigned int)range);
+}
+
+StateHash::StateHash(): value(14695981039346656037ull) {}
+
+void StateHash::Add(const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < size; i++) {
+        value = (value ^ bytes[i]) * 1099511628211ull;
+    }
+}
+
+void StateHash::Add(float value) {
+    Add(&value, sizeof(value));
+}
+
+void StateHash::Add(int value) {
+    Add(&value, sizeof(value));
+}
+
+void StateHash::Add(const std::vector<float> &values) {
+    if (!values.empty()) {
+        Add(&values[0], values.size() * sizeof(float));
+    }
+}
+
+static void WriteU32(std::ofstream &file, unsigned int value) {
+    for (int i = 0; i < 4; i++) {
+        file.put((char)((value >> (i * 8)) & 0xFF));
+    }
+}
+
+static unsigned int ReadU32(std::ifstream &file) {
+    unsigned int value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= (unsigned int)(unsigned char)file.get() << (i * 8);
+    }
+    return value;
+}
+
+// 7 bits at a time, high bit set while more follow
+static void WriteVarint(std::ofstream &file, unsigned int value) {
+    while (value >= 0x80) {
+        file.put((char)((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    file.put((char)value);
+}
+
+static unsigned int ReadVarint(std::ifstream &file) {
+    unsigned int value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        int byte = file.get();
+        if (byte == EOF) {
+            break;
+        }
+        value |= (unsigned int)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+    return value;
+}
+
+Replay::Replay(): seed(1), startMode(0), tickCount(0), finalHash(0), playRun(0), playTick(0), ticksPlayed(0) {}
+
+void Replay::Begin(unsigned int seed, unsigned char startMode) {
+    this->seed = seed;
+    this->startMode = startMode;
+    tickCount = 0;
+    finalHash = 0;
+    runs.clear();
+    playRun = 0;
+    playTick = 0;
+    ticksPlayed = 0;
+}
+
+void Replay::AddTick(unsigned char input) {
+    if (runs.empty() || runs.back().input != input) {
+        Run run = {input, 0};
+        runs.push_back(run);
+    }
+    runs.back().length++;
+    tickCount++;
+}
+
+bool Replay::Save(const char *path, unsigned long long finalHash) const {
+    std::ofstream file(path, std::ios::binary);
+    if (file.fail()) {
+        std::cout << "Unable to write replay " << path << std::endl;
+        return false;
+    }
+    file.write(REPLAY_MAGIC, 4);
+    WriteU32(file, REPLAY_VERSION);
+    WriteU32(file, seed);
+    file.put((char)startMode);
+    WriteU32(file, tickCount);
+    WriteU32(file, (unsigned int)runs.size());
+    for (size_t i = 0; i < runs.size(); i++) {
+        file.put((char)runs[i].input);
+        WriteVarint(file, runs[i].length);
+    }
+    WriteU32(file, (unsigned int)(finalHash & 0xFFFFFFFFu));
+    WriteU32(file, (unsigned int)(finalHash >> 32));
+    return !file.fail();
+}
+
+bool Replay::Load(const char *path) {
+    std::ifstream file(path, std::ios::binary);
+    if (file.fail()) {
+        std::cout << "Unable to open replay " << path << std::endl;
+        return false;
+    }
+    char magic[4];
+    file.read(magic, 4);
+    if (file.fail() || memcmp(magic, REPLAY_MAGIC, 4) != 0) {
+        std::cout << path << " is not a replay" << std::endl;
+        return false;
+    }
+    unsigned int version = ReadU32(file);
+    if (version != REPLAY_VERSION) {
+        std::cout << "Replay " << path << " has version " << version << ", expected " << REPLAY_VERSION << std::endl;
+        return false;
+    }
+    unsigned int fileSeed = ReadU32(file);
+    unsigned char fileStartMode = (unsigned char)file.get();
+    Begin(fileSeed, fileStartMode);
+    unsigned int expectedTicks = ReadU32(file);
+    unsigned int runCount = ReadU32(file);
+    for (unsigned int i = 0; i < runCount && !file.fail(); i++) {
+        Run run;
+        run.input = (unsigned char)file.get();
+        run.length = ReadVarint(file);
+        runs.push_back(run);
+        tickCount += run.length;
+    }
+    unsigned long long low = ReadU32(file);
+    unsigned long long high = ReadU32(file);
+    finalHash = low | (high << 32);
+    if (file.fail() || tickCount != expectedTicks) {
+        std::cout << "Replay " << path << " is truncated" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+unsigned char Replay::NextInput() {
+    while (playRun < runs.size() && playTick >= runs[playRun].length) {
+        playRun++;
+        playTick = 0;
+    }
+    if (playRun >= runs.size()) {
+        return 0;
+    }
+    playTick++;
+    ticksPlayed++;
+    return runs[playRun].input;
+}
+
+bool Replay::Finished() const {
+    return ticksPlayed >= tickCount;
+}
+
+unsigned int Replay::RemainingTicks() const {
+    return tickCount - ticksPlayed;
+}
+
+static const char *PathArgument(int argc, char *argv[], const char *flag, const char *variable) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (strcmp(argv[i], flag) == 0) {
+            return argv[i + 1];
+        }
+    }
+    const char *env = getenv(variable);
+    return env != NULL && env[0] != '\0' ? env : NULL;
+}
+
+const char *RecordPath(int argc, char *argv[]) {
+    return PathArgument(argc, argv, "--record", "RECORD");
+}
+
+const char *ReplayPath(int argc, char *argv[]) {
+    return PathArgument(argc, argv, "--replay", "REPLAY");
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// bits of the input a simulation tick reads
+#define INPUT_LEFT 1
+#define INPUT_RIGHT 2
+#define INPUT_RESTART 4
+
+// Xorshift generator used for spawning instead of rand(), so a seed gives the
+// same sequence on every platform and C library.
+class Random {
+    public:
+
+        Random(unsigned int seed = 1);
+
+        void Seed(unsigned int seed);
+        unsigned int Next();
+        // uniform in [0, range)
+        int Range(int range);
+
+        unsigned int state;
+};
+
+// FNV-1a over the bytes of everything added, for comparing simulation states.
+class StateHash {
+    public:
+
+        StateHash();
+
+        void Add(const void *data, size_t size);
+        void Add(float value);
+        void Add(int value);
+        void Add(const std::vector<float> &values);
+
+        unsigned long long value;
+};
+
+// The input of every simulation tick and the seed spawns were drawn from, which
+// is everything needed to play a session again. Held keys repeat for hundreds of
+// ticks, so ticks are stored as runs of identical input.
+//
+// File layout, little endian:
+//   "PGRP", version (u32), seed (u32), start mode (u8), tick count (u32),
+//   run count (u32), runs of input (u8) and length (varint), final state hash (u64)
+class Replay {
+    public:
+
+        Replay();
+
+        // starts a new recording
+        void Begin(unsigned int seed, unsigned char startMode);
+        void AddTick(unsigned char input);
+        bool Save(const char *path, unsigned long long finalHash) const;
+
+        bool Load(const char *path);
+        // input for the next tick when playing back, 0 past the end
+        unsigned char NextInput();
+        bool Finished() const;
+        unsigned int RemainingTicks() const;
+
+        unsigned int seed;
+        unsigned char startMode;
+        unsigned int tickCount;
+        // state hash after the last tick, as the recording ended
+        unsigned long long finalHash;
+
+    private:
+
+        struct Run {
+            unsigned char input;
+            unsigned int length;
+        };
+
+        std::vector<Run> runs;
+        size_t playRun;
+        unsigned int playTick;
+        unsigned int ticksPlayed;
+};
+
+// --record <file> on the command line or RECORD=<file> in the environment, NULL if neither
+const char *RecordPath(int argc, char *argv[]);
+
+// --replay <file> on the command line or REPLAY=<file> in the environment, NULL if neither
+const char *ReplayPath(int argc, char *argv[]);
@@ -0,0 +1,212 @@
+#include "SpatialHash.h"
+#include <cmath>
+#include <algorithm>
+
+// entities per chunk in the threaded build, and buckets per chunk in the threaded pair search
+#define SPATIAL_HASH_BUILD_GRAIN 16384
+#define SPATIAL_HASH_PAIR_GRAIN 256
+
+SpatialHash::SpatialHash(float cellSize, size_t bucketCount): cellSize(cellSize), store(NULL), currentQuery(0) {
+    size_t buckets = 1;
+    while (buckets < bucketCount) {
+        buckets *= 2;
+    }
+    bucketMask = buckets - 1;
+}
+
+int SpatialHash::Cell(float coordinate) const {
+    return (int)floorf(coordinate / cellSize);
+}
+
+size_t SpatialHash::Bucket(int cellX, int cellY) const {
+    unsigned int hash = ((unsigned int)cellX * 73856093u) ^ ((unsigned int)cellY * 19349663u);
+    return hash & bucketMask;
+}
+
+void SpatialHash::CellRange(size_t entity, int &minX, int &maxX, int &minY, int &maxY) const {
+    float halfWidth = store->width[entity] / 2.0f;
+    float halfHeight = store->height[entity] / 2.0f;
+    minX = Cell(store->positionX[entity] - halfWidth);
+    maxX = Cell(store->positionX[entity] + halfWidth);
+    minY = Cell(store->positionY[entity] - halfHeight);
+    maxY = Cell(store->positionY[entity] + halfHeight);
+}
+
+void SpatialHash::Build(const EntityStore &store) {
+    this->store = &store;
+    size_t count = store.Size();
+
+    // first pass counts the entries per bucket, shifted by one for the prefix sum
+    bucketStart.assign(bucketMask + 2, 0);
+    for (size_t i = 0; i < count; i++) {
+        int minX, maxX, minY, maxY;
+        CellRange(i, minX, maxX, minY, maxY);
+        for (int y = minY; y <= maxY; y++) {
+            for (int x = minX; x <= maxX; x++) {
+                bucketStart[Bucket(x, y) + 1]++;
+            }
+        }
+    }
+    for (size_t b = 1; b < bucketStart.size(); b++) {
+        bucketStart[b] += bucketStart[b - 1];
+    }
+
+    // second pass writes entity indices, so each bucket lists them in ascending order
+    entries.resize(bucketStart.back());
+    bucketFill.assign(bucketStart.begin(), bucketStart.end() - 1);
+    for (size_t i = 0; i < count; i++) {
+        int minX, maxX, minY, maxY;
+        CellRange(i, minX, maxX, minY, maxY);
+        for (int y = minY; y <= maxY; y++) {
+            for (int x = minX; x <= maxX; x++) {
+                entries[bucketFill[Bucket(x, y)]++] = (unsigned int)i;
+            }
+        }
+    }
+
+    queryStamp.assign(count, 0);
+    currentQuery = 0;
+}
+
+void SpatialHash::Build(const EntityStore &store, JobSystem &jobs) {
+    this->store = &store;
+    size_t count = store.Size();
+    size_t buckets = bucketMask + 1;
+    size_t chunks = JobSystem::ChunkCount(count, SPATIAL_HASH_BUILD_GRAIN);
+
+    // each chunk counts into its own column, so no two threads touch the same counter.
+    // bucket major, so the prefix sum below walks memory in order
+    chunkFill.assign(buckets * chunks, 0);
+    jobs.ParallelFor(count, SPATIAL_HASH_BUILD_GRAIN, [&](size_t begin, size_t end) {
+        unsigned int *fill = &chunkFill[begin / SPATIAL_HASH_BUILD_GRAIN];
+        for (size_t i = begin; i < end; i++) {
+            int minX, maxX, minY, maxY;
+            CellRange(i, minX, maxX, minY, maxY);
+            for (int y = minY; y <= maxY; y++) {
+                for (int x = minX; x <= maxX; x++) {
+                    fill[Bucket(x, y) * chunks]++;
+                }
+            }
+        }
+    });
+
+    // within a bucket chunk 0 writes first, then chunk 1 and so on, which keeps indices ascending
+    bucketStart.resize(buckets + 1);
+    unsigned int total = 0;
+    for (size_t b = 0; b < buckets; b++) {
+        bucketStart[b] = total;
+        for (size_t c = 0; c < chunks; c++) {
+            unsigned int entriesInChunk = chunkFill[b * chunks + c];
+            chunkFill[b * chunks + c] = total;
+            total += entriesInChunk;
+        }
+    }
+    bucketStart[buckets] = total;
+
+    entries.resize(total);
+    jobs.ParallelFor(count, SPATIAL_HASH_BUILD_GRAIN, [&](size_t begin, size_t end) {
+        unsigned int *fill = &chunkFill[begin / SPATIAL_HASH_BUILD_GRAIN];
+        for (size_t i = begin; i < end; i++) {
+            int minX, maxX, minY, maxY;
+            CellRange(i, minX, maxX, minY, maxY);
+            for (int y = minY; y <= maxY; y++) {
+                for (int x = minX; x <= maxX; x++) {
+                    entries[fill[Bucket(x, y) * chunks]++] = (unsigned int)i;
+                }
+            }
+        }
+    });
+
+    queryStamp.assign(count, 0);
+    currentQuery = 0;
+}
+
+void SpatialHash::Query(float x, float y, float width, float height, std::vector<size_t> &candidates) {
+    candidates.clear();
+    if (store == NULL) {
+        return;
+    }
+    currentQuery++;
+    if (currentQuery == 0) {
+        std::fill(queryStamp.begin(), queryStamp.end(), 0);
+        currentQuery = 1;
+    }
+
+    int minX = Cell(x - width / 2.0f);
+    int maxX = Cell(x + width / 2.0f);
+    int minY = Cell(y - height / 2.0f);
+    int maxY = Cell(y + height / 2.0f);
+    for (int cellY = minY; cellY <= maxY; cellY++) {
+        for (int cellX = minX; cellX <= maxX; cellX++) {
+            size_t bucket = Bucket(cellX, cellY);
+            for (unsigned int k = bucketStart[bucket]; k < bucketStart[bucket + 1]; k++) {
+                unsigned int entity = entries[k];
+                if (queryStamp[entity] != currentQuery) {
+                    queryStamp[entity] = currentQuery;
+                    candidates.push_back(entity);
+                }
+            }
+        }
+    }
+}
+
+void SpatialHash::FindPairs(std::vector<std::pair<size_t, size_t> > &pairs) const {
+    pairs.clear();
+    if (store == NULL) {
+        return;
+    }
+    for (size_t bucket = 0; bucket <= bucketMask; bucket++) {
+        PairsInBucket(bucket, pairs);
+    }
+}
+
+void SpatialHash::FindPairs(std::vector<std::pair<size_t, size_t> > &pairs, JobSystem &jobs) {
+    pairs.clear();
+    if (store == NULL) {
+        return;
+    }
+    size_t buckets = bucketMask + 1;
+    chunkPairs.resize(JobSystem::ChunkCount(buckets, SPATIAL_HASH_PAIR_GRAIN));
+    jobs.ParallelFor(buckets, SPATIAL_HASH_PAIR_GRAIN, [&](size_t begin, size_t end) {
+        std::vector<std::pair<size_t, size_t> > &found = chunkPairs[begin / SPATIAL_HASH_PAIR_GRAIN];
+        found.clear();
+        for (size_t bucket = begin; bucket < end; bucket++) {
+            PairsInBucket(bucket, found);
+        }
+    });
+    // joined in bucket order, the same list the single threaded search makes
+    for (size_t c = 0; c < chunkPairs.size(); c++) {
+        pairs.insert(pairs.end(), chunkPairs[c].begin(), chunkPairs[c].end());
+    }
+}
+
+void SpatialHash::PairsInBucket(size_t bucket, std::vector<std::pair<size_t, size_t> > &pairs) const {
+    const EntityStore &s = *store;
+    unsigned int start = bucketStart[bucket];
+    unsigned int end = bucketStart[bucket + 1];
+    for (unsigned int j = start; j < end; j++) {
+        unsigned int a = entries[j];
+        // an entity covering two cells that hash to the same bucket shows up twice in a row
+        if (j > start && entries[j - 1] == a) {
+            continue;
+        }
+        for (unsigned int k = j + 1; k < end; k++) {
+            unsigned int b = entries[k];
+            if (b == a || entries[k - 1] == b) {
+                continue;
+            }
+            float minX = std::max(s.positionX[a] - s.width[a] / 2.0f, s.positionX[b] - s.width[b] / 2.0f);
+            float maxX = std::min(s.positionX[a] + s.width[a] / 2.0f, s.positionX[b] + s.width[b] / 2.0f);
+            float minY = std::max(s.positionY[a] - s.height[a] / 2.0f, s.positionY[b] - s.height[b] / 2.0f);
+            float maxY = std::min(s.positionY[a] + s.height[a] / 2.0f, s.positionY[b] + s.height[b] / 2.0f);
+            if (minX >= maxX || minY >= maxY) {
+                continue;
+            }
+            // boxes sharing several cells are only reported from the cell holding their overlap's corner
+            if (Bucket(Cell(minX), Cell(minY)) != bucket) {
+                continue;
+            }
+            pairs.push_back(std::make_pair((size_t)a, (size_t)b));
+        }
+    }
+}
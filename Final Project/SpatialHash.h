@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include "EntityStore.h"
+#include "JobSystem.h"
+
+// Uniform grid broadphase over the entities in an EntityStore. Every entity is
+// inserted into each cell its bounding box touches, and cells are hashed into a
+// fixed number of buckets stored back to back (bucketStart[b] .. bucketStart[b + 1]
+// in entries), so a rebuild is two linear passes with no per-cell allocation.
+// Positions are box centres, as everywhere else in the game.
+class SpatialHash {
+    public:
+
+        // bucketCount is rounded up to a power of two
+        SpatialHash(float cellSize = 0.5f, size_t bucketCount = 1024);
+
+        void Build(const EntityStore &store);
+        // same buckets, in the same order, built by chunks of entities on the job threads
+        void Build(const EntityStore &store, JobSystem &jobs);
+
+        // indices of entities whose cells overlap the box, each reported once
+        void Query(float x, float y, float width, float height, std::vector<size_t> &candidates);
+        // pairs of entities whose boxes overlap, each reported once with first < second
+        void FindPairs(std::vector<std::pair<size_t, size_t> > &pairs) const;
+        // same pairs in the same order, with ranges of buckets searched on the job threads
+        void FindPairs(std::vector<std::pair<size_t, size_t> > &pairs, JobSystem &jobs);
+
+        float cellSize;
+
+    private:
+
+        size_t Bucket(int cellX, int cellY) const;
+        int Cell(float coordinate) const;
+        void CellRange(size_t entity, int &minX, int &maxX, int &minY, int &maxY) const;
+        void PairsInBucket(size_t bucket, std::vector<std::pair<size_t, size_t> > &pairs) const;
+
+        const EntityStore *store;
+        size_t bucketMask;
+        std::vector<unsigned int> bucketStart;
+        std::vector<unsigned int> entries;
+        std::vector<unsigned int> bucketFill;
+        // per chunk bucket counts, then write positions, for the threaded build
+        std::vector<unsigned int> chunkFill;
+        std::vector<std::vector<std::pair<size_t, size_t> > > chunkPairs;
+
+        // per entity stamp of the last query that reported it
+        std::vector<unsigned int> queryStamp;
+        unsigned int currentQuery;
+};
@@ -0,0 +1,94 @@
+#include "SpriteBatch.h"
+#include "glm/gtc/matrix_transform.hpp"
+
+// x, y, u, v per vertex
+#define FLOATS_PER_VERTEX 4
+#define VERTICES_PER_QUAD 6
+
+SpriteBatch::SpriteBatch(): drawCalls(0), vertexCount(0), program(NULL), vertexBuffer(0), currentTexture(0), maxQuads(0) {}
+
+void SpriteBatch::Load(size_t maxQuads) {
+    this->maxQuads = maxQuads;
+    vertexData.reserve(maxQuads * VERTICES_PER_QUAD * FLOATS_PER_VERTEX);
+    
+    // allocate the buffer once, every flush only streams into it
+    glGenBuffers(1, &vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, maxQuads * VERTICES_PER_QUAD * FLOATS_PER_VERTEX * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SpriteBatch::Cleanup() {
+    glDeleteBuffers(1, &vertexBuffer);
+    vertexBuffer = 0;
+}
+
+void SpriteBatch::Begin(ShaderProgram &program) {
+    this->program = &program;
+    currentTexture = 0;
+    vertexData.clear();
+    
+    // quads are already in world space
+    program.SetModelMatrix(glm::mat4(1.0f));
+}
+
+void SpriteBatch::DrawQuad(GLuint texture, float x, float y, float width, float height, float u0, float v0, float u1, float v1) {
+    if (texture != currentTexture || vertexData.size() >= maxQuads * VERTICES_PER_QUAD * FLOATS_PER_VERTEX) {
+        Flush();
+        currentTexture = texture;
+    }
+    
+    float left = x - width * 0.5f;
+    float right = x + width * 0.5f;
+    float bottom = y - height * 0.5f;
+    float top = y + height * 0.5f;
+    
+    // same winding and texture orientation as Entity::Draw
+    vertexData.insert(vertexData.end(), {
+        left, bottom, u0, v1,
+        right, bottom, u1, v1,
+        right, top, u1, v0,
+        left, bottom, u0, v1,
+        right, top, u1, v0,
+        left, top, u0, v0
+    });
+}
+
+void SpriteBatch::Flush() {
+    if (vertexData.empty()) {
+        return;
+    }
+    
+    glBindTexture(GL_TEXTURE_2D, currentTexture);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    // orphan the previous contents so the driver does not wait on the last draw
+    glBufferData(GL_ARRAY_BUFFER, maxQuads * VERTICES_PER_QUAD * FLOATS_PER_VERTEX * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, vertexData.size() * sizeof(float), vertexData.data());
+    
+    GLsizei stride = FLOATS_PER_VERTEX * sizeof(float);
+    glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, stride, (void*)0);
+    glEnableVertexAttribArray(program->positionAttribute);
+    
+    glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, stride, (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(program->texCoordAttribute);
+    
+    GLsizei vertices = (GLsizei)(vertexData.size() / FLOATS_PER_VERTEX);
+    glDrawArrays(GL_TRIANGLES, 0, vertices);
+    
+    glDisableVertexAttribArray(program->positionAttribute);
+    glDisableVertexAttribArray(program->texCoordAttribute);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    
+    drawCalls++;
+    vertexCount += vertices;
+    vertexData.clear();
+}
+
+void SpriteBatch::End() {
+    Flush();
+}
+
+void SpriteBatch::ResetStats() {
+    drawCalls = 0;
+    vertexCount = 0;
+}
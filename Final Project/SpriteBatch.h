@@ -0,0 +1,39 @@
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+#include <vector>
+#include "ShaderProgram.h"
+
+// Collects textured quads in world space and submits them with one draw call
+// per texture run instead of one draw call per sprite.
+class SpriteBatch {
+    public:
+    
+        SpriteBatch();
+    
+        void Load(size_t maxQuads = 1024);
+        void Cleanup();
+    
+        void Begin(ShaderProgram &program);
+        void DrawQuad(GLuint texture, float x, float y, float width, float height,
+                      float u0 = 0.0f, float v0 = 0.0f, float u1 = 1.0f, float v1 = 1.0f);
+        void Flush();
+        void End();
+    
+        void ResetStats();
+    
+        // counters for the current frame, cleared by ResetStats()
+        int drawCalls;
+        int vertexCount;
+    
+    private:
+    
+        ShaderProgram *program;
+        GLuint vertexBuffer;
+        GLuint currentTexture;
+        size_t maxQuads;
+        std::vector<float> vertexData;
+};
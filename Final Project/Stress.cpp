@@ -0,0 +1,160 @@
+// Runs the hazard simulation with a very large number of crates and birds on
+// 1, 2, 4 ... threads up to one per core, and reports the time per step for
+// updating, rebuilding the broadphase and finding overlapping pairs. Every
+// thread count has to end in exactly the same state, which is checked by
+// hashing positions, sprites and pairs. At least 2 threads are always run, so
+// the check happens on a single core machine too, and [threads] raises the
+// limit above the core count.
+//
+//   g++ -O2 -std=c++11 -mavx -pthread Stress.cpp Hazards.cpp EntityStore.cpp SpatialHash.cpp JobSystem.cpp -o Stress
+//   ./Stress [hazards] [steps] [threads]
+
+#include "Hazards.h"
+#include "EntityStore.h"
+#include "SpatialHash.h"
+#include "JobSystem.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+// the screen's width with a column tall enough for about four hazards per square unit
+#define FIELD_HALF_WIDTH 0.95f
+#define HAZARDS_PER_AREA 4.0f
+
+// sprites are only compared by address, so any distinct pointers will do
+static const char birdFrames[4] = {0, 0, 0, 0};
+
+struct StressTimes {
+    double update;
+    double build;
+    double pairs;
+    size_t pairCount;
+    unsigned long long hash;
+};
+
+static float RandomFloat(float low, float high) {
+    return low + (high - low) * (float)rand() / (float)RAND_MAX;
+}
+
+static double Seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static unsigned long long HashBytes(unsigned long long hash, const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// same sizes and speeds as the game spawns, scaled down so the field is not one solid pile
+static void SpawnHazards(size_t count, EntityStore &hazards, std::vector<HazardInfo> &hazardInfo, const BirdSprites &sprites) {
+    srand(1);
+    float halfHeight = count / (HAZARDS_PER_AREA * 2.0f * FIELD_HALF_WIDTH) / 2.0f;
+    hazards.Clear();
+    hazardInfo.clear();
+    hazards.Reserve(count);
+    hazardInfo.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        float x = RandomFloat(-FIELD_HALF_WIDTH, FIELD_HALF_WIDTH);
+        float y = RandomFloat(-halfHeight, halfHeight);
+        HazardInfo info;
+        info.timeSinceLastFlap = RandomFloat(0.0f, 0.5f);
+        if (i % 2 == 0) {
+            hazards.Add(x, y, 0.0f, -0.7f, 0.06f, 0.05f);
+            info.kind = HAZARD_BOX;
+            info.sprite = NULL;
+        } else {
+            hazards.Add(x, y, rand() % 2 ? 0.3f : -0.3f, -0.4f, 0.042f, 0.035f);
+            info.kind = HAZARD_BIRD;
+            info.sprite = sprites.bird1;
+        }
+        hazardInfo.push_back(info);
+    }
+}
+
+static StressTimes RunStress(size_t count, int steps, int workers) {
+    BirdSprites sprites = {(const AtlasRegion *)&birdFrames[0], (const AtlasRegion *)&birdFrames[1], (const AtlasRegion *)&birdFrames[2], (const AtlasRegion *)&birdFrames[3]};
+    EntityStore hazards;
+    std::vector<HazardInfo> hazardInfo;
+    SpawnHazards(count, hazards, hazardInfo, sprites);
+
+    JobSystem jobs(workers);
+    SpatialHash broadphase(0.5f, 65536);
+    std::vector<std::pair<size_t, size_t> > pairs;
+    StressTimes times = {0.0, 0.0, 0.0, 0, 14695981039346656037ull};
+    const float timestep = 1.0f / 120.0f;
+
+    for (int step = 0; step < steps; step++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        UpdateHazards(timestep, hazards, hazardInfo, sprites, jobs);
+        times.update += Seconds(start);
+
+        start = std::chrono::steady_clock::now();
+        broadphase.Build(hazards, jobs);
+        times.build += Seconds(start);
+
+        start = std::chrono::steady_clock::now();
+        broadphase.FindPairs(pairs, jobs);
+        times.pairs += Seconds(start);
+
+        times.pairCount += pairs.size();
+        if (!pairs.empty()) {
+            times.hash = HashBytes(times.hash, &pairs[0], pairs.size() * sizeof(pairs[0]));
+        }
+    }
+
+    times.hash = HashBytes(times.hash, &hazards.positionX[0], count * sizeof(float));
+    times.hash = HashBytes(times.hash, &hazards.positionY[0], count * sizeof(float));
+    times.hash = HashBytes(times.hash, &hazards.velocityX[0], count * sizeof(float));
+    for (size_t i = 0; i < count; i++) {
+        size_t frame = hazardInfo[i].sprite == NULL ? 4 : (const char *)hazardInfo[i].sprite - birdFrames;
+        times.hash = HashBytes(times.hash, &frame, sizeof(frame));
+    }
+    times.update /= steps;
+    times.build /= steps;
+    times.pairs /= steps;
+    return times;
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? (size_t)atol(argv[1]) : 200000;
+    int steps = argc > 2 ? atoi(argv[2]) : 120;
+    int cores = (int)std::thread::hardware_concurrency();
+    int maxThreads = argc > 3 ? atoi(argv[3]) : cores;
+    if (count == 0 || steps <= 0 || (argc > 3 && maxThreads <= 0)) {
+        printf("usage: Stress [hazards] [steps] [threads]\n");
+        return 1;
+    }
+    // determinism needs something to compare the single thread run with
+    maxThreads = std::max(maxThreads, 2);
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    printf("%zu hazards, %d steps, %d cores\n", count, steps, cores);
+    printf("threads  update ms  build ms  pairs ms  total ms  speedup  pairs/step\n");
+    StressTimes single = {0.0, 0.0, 0.0, 0, 0};
+    bool matches = true;
+    for (size_t t = 0; t < threadCounts.size(); t++) {
+        int threads = threadCounts[t];
+        StressTimes times = RunStress(count, steps, threads - 1);
+        double total = times.update + times.build + times.pairs;
+        if (threads == 1) {
+            single = times;
+        } else if (times.hash != single.hash || times.pairCount != single.pairCount) {
+            printf("state after %d threads differs from 1 thread\n", threads);
+            matches = false;
+        }
+        double singleTotal = single.update + single.build + single.pairs;
+        printf("%7d  %9.3f  %8.3f  %8.3f  %8.3f  %6.2fx  %10zu\n", threads, times.update * 1e3, times.build * 1e3, times.pairs * 1e3, total * 1e3, singleTotal / total, times.pairCount / steps);
+    }
+    return matches ? 0 : 1;
+}
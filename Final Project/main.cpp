@@ -8,11 +8,28 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #include "ShaderProgram.h"
+#include "SpriteBatch.h"
+#include "TextureAtlas.h"
+#include "TextRenderer.h"
+#include "RenderQueue.h"
+#include "Headless.h"
+#include "Profiler.h"
+#include "EntityStore.h"
+#include "SpatialHash.h"
+#include "SweptCollision.h"
+#include "GameLoop.h"
+#include "HandlePool.h"
+#include "JobSystem.h"
+#include "Hazards.h"
+#include "Replay.h"
+#include "AssetLoader.h"
+#include "TextureManager.h"
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include <SDL_mixer.h>
 #include <cmath>
 #include <vector>
+#include <ctime>
 #ifdef _WINDOWS
 #define RESOURCE_FOLDER ""
 #else
@@ -21,79 +38,38 @@
 #endif
 
 SDL_Window* displayWindow;
+HeadlessContext headless;
 using namespace std;
 
 enum GameMode {START_SCREEN, GAME_ON, GAME_OVER};
 
-GLuint LoadTexture(const char *filePath) {
-    int w,h,comp;
-    unsigned char* image = stbi_load(filePath, &w, &h, &comp, STBI_rgb_alpha);
-    if(image == NULL) {
-        std::cout << "Unable to load image. Make sure the path is correct\n";
-        assert(false);
-    }
-    GLuint retTexture;
-    glGenTextures(1, &retTexture);
-    glBindTexture(GL_TEXTURE_2D, retTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    stbi_image_free(image);
-    return retTexture;
+//crates and birds alive at once, spawns beyond this are skipped
+#define MAX_HAZARDS 256
+//replays render one frame per second of game time
+#define REPLAY_TICKS_PER_FRAME 120
+
+//1x1 white texture for drawing plain rectangles before the atlas is in
+GLuint CreateWhiteTexture() {
+    unsigned char white[4] = {255, 255, 255, 255};
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    return texture;
 }
 
- void DrawText(ShaderProgram &program, int fontTexture, std::string text, float size, float spacing, float xPos, float yPos) {
-    float character_size = 1.0/16.0f;
-    vector<float> vertexData;
-    vector<float> texCoordData;
-    for(int i=0; i < text.size(); i++) {
-        int spriteIndex = (int)text[i];
-        float texture_x = (float)(spriteIndex % 16) / 16.0f;
-        float texture_y = (float)(spriteIndex / 16) / 16.0f;
-        vertexData.insert(vertexData.end(), {
-            ((size+spacing) * i) + (-0.5f * size), 0.5f * size,
-            ((size+spacing) * i) + (-0.5f * size), -0.5f * size,
-            ((size+spacing) * i) + (0.5f * size), 0.5f * size,
-            ((size+spacing) * i) + (0.5f * size), -0.5f * size,
-            ((size+spacing) * i) + (0.5f * size), 0.5f * size,
-            ((size+spacing) * i) + (-0.5f * size), -0.5f * size,
-        });
-        texCoordData.insert(texCoordData.end(), {
-            texture_x, texture_y,
-            texture_x, texture_y + character_size,
-            texture_x + character_size, texture_y,
-            texture_x + character_size, texture_y + character_size,
-            texture_x + character_size, texture_y,
-            texture_x, texture_y + character_size,
-        });
-    }
-    
-    //draw the text on the screen
-    glBindTexture(GL_TEXTURE_2D, fontTexture);
-    float* v = vertexData.data();
-    float* t = texCoordData.data();
-    
-    for (int i = 1;  i < text.size() * 2; i++){
-        glm::mat4 modelMatrix = glm::mat4(1.0f);
-   
-        modelMatrix = glm::translate(modelMatrix, glm::vec3(xPos, yPos, 0.0f));
-    
-        program.SetModelMatrix(modelMatrix);
-    
-        glVertexAttribPointer(program.positionAttribute, 2, GL_FLOAT, false, 0, v);
-        glEnableVertexAttribArray(program.positionAttribute);
-    
-        glVertexAttribPointer(program.texCoordAttribute, 2, GL_FLOAT, false, 0, t);
-        glEnableVertexAttribArray(program.texCoordAttribute);
-    
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-    
-        glDisableVertexAttribArray(program.positionAttribute);
-        glDisableVertexAttribArray(program.texCoordAttribute);
-        
-        v += 6;
-        t += 6;
-    }
+double MillisecondsSince(Uint64 start) {
+    return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+//every sprite the game draws, AtlasPacker packs them into sprites.ktx from their own pngs
+#define SPRITE_COUNT 12
+const char *spriteNames[SPRITE_COUNT] = {"Plane", "crate", "cloud", "cloud2", "bird", "bird2", "birdR1", "birdR2", "font1", "explosion", "arrowRight", "arrowLeft"};
+
+string SpritePath(const char *name) {
+    return string(RESOURCE_FOLDER) + name + ".png";
 }
 
 struct vec2 {
@@ -104,45 +80,21 @@ struct vec2 {
 class Entity {
     public:
     vec2 position;
+    //position before the last simulation step
+    vec2 previousPosition;
     vec2 velocity;
-    unsigned int TextureID;
+    const AtlasRegion *sprite;
     float scaleFactor;
     float width;
     float height;
-    float timeSinceLastFlap;
-    
-    Entity(unsigned int tex , vec2 pos, float sf = 1.0f, vec2 vel = vec2(0.0f, 0.0f)): velocity(vel), TextureID(tex), position(pos), scaleFactor(sf), timeSinceLastFlap(0.0f){}
-    
-    void Draw(ShaderProgram &program){
-    
-        glBindTexture(GL_TEXTURE_2D, TextureID);
-        #define DEFAULT_VERTICES {-0.5, -0.5, 0.5, -0.5, 0.5, 0.5,-0.5, -0.5, 0.5, 0.5, -0.5, 0.5}
-
-        glm::mat4 modelMatrix = glm::mat4(1.0f);
-   
-        modelMatrix = glm::translate(modelMatrix, glm::vec3(position.x, position.y, 0.0f));
-        modelMatrix = glm::scale(modelMatrix, glm::vec3(scaleFactor*0.6, scaleFactor*0.5, 1.0f));
-        width = scaleFactor*0.6;
-        height = scaleFactor*0.5;
-    
-        program.SetModelMatrix(modelMatrix);
-
-        float vertices[] = DEFAULT_VERTICES;
-    
-        glVertexAttribPointer(program.positionAttribute, 2, GL_FLOAT, false, 0, vertices);
-        glEnableVertexAttribArray(program.positionAttribute);
-
-        float textCoords[] = {0.0, 1.0, 1.0, 1.0, 1.0, 0.0, 0.0, 1.0, 1.0, 0.0, 0.0, 0.0};
-    
-        glVertexAttribPointer(program.texCoordAttribute, 2, GL_FLOAT, false, 0, textCoords);
-        glEnableVertexAttribArray(program.texCoordAttribute);
     
+    Entity(const AtlasRegion *sprite, vec2 pos, float sf = 1.0f, vec2 vel = vec2(0.0f, 0.0f)): velocity(vel), sprite(sprite), position(pos), previousPosition(pos), scaleFactor(sf), width(sf*0.6f), height(sf*0.5f){}
     
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        
-        glDisableVertexAttribArray(program.positionAttribute);
-        glDisableVertexAttribArray(program.texCoordAttribute);
-    
+    //alpha blends from the previous to the current position, see GameLoop::Alpha
+    void Draw(RenderQueue &queue, ShaderProgram &program, RenderLayer layer, float alpha = 1.0f){
+        float x = previousPosition.x + (position.x - previousPosition.x)*alpha;
+        float y = previousPosition.y + (position.y - previousPosition.y)*alpha;
+        queue.SubmitQuad(layer, program, sprite->texture, 0.5f, x, y, width, height, sprite->u0, sprite->v0, sprite->u1, sprite->v1);
     }
     
     bool didCollideWith(Entity &otherEntity){
@@ -152,107 +104,183 @@ class Entity {
         return false;
     }
     
+    //swept test over the last step, so a long frame cannot carry a hazard through the plane
+    bool didCollideWith(const EntityStore &store, size_t index, float elapsed){
+        MovingBox self = RewoundBox(previousPosition.x, previousPosition.y, position.x, position.y, width, height, elapsed);
+        MovingBox other = RewoundBox(store.previousX[index], store.previousY[index], store.positionX[index], store.positionY[index], store.width[index], store.height[index], elapsed);
+        Impact impact;
+        return SweepBoxes(self, other, elapsed, impact);
+    }
+    
 };
 
 class GameState{
     public:
     Entity plane;
-    vector<Entity> boxes;
-    vector<Entity> birds;
+    //crates and birds, positions and velocities in hazards, the rest in hazardInfo at the same index.
+    //hazardHandles keeps handles to them valid while others are removed around them
+    HandleTable hazardHandles;
+    EntityStore hazards;
+    vector<HazardInfo> hazardInfo;
     int score;
     float timeTillNextBox;
     float timeTillNextBird;
+    //draws spawn positions, seeded once per session and carried across restarts
+    Random random;
     
-    GameState(unsigned int planeTex, unsigned int boxTex): score(0), plane(planeTex, vec2(0.0, -0.8), 0.8), timeTillNextBox(0.0f), timeTillNextBird(10.0f) { }
+    GameState(const AtlasRegion *planeSprite): score(0), plane(planeSprite, vec2(0.0, -0.8), 0.8), timeTillNextBox(0.0f), timeTillNextBird(10.0f) {
+        hazardHandles.Reset(MAX_HAZARDS);
+        hazards.Reserve(MAX_HAZARDS);
+        hazardInfo.reserve(MAX_HAZARDS);
+    }
     
-};
-
-void Setup(){
-    SDL_Init(SDL_INIT_VIDEO);
-    displayWindow = SDL_CreateWindow("My Game", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 375, 667, SDL_WINDOW_OPENGL);
-    SDL_GLContext context = SDL_GL_CreateContext(displayWindow);
-    SDL_GL_MakeCurrent(displayWindow, context);
+    //starts a new game, keeping the storage already allocated
+    void Reset(const AtlasRegion *planeSprite){
+        plane = Entity(planeSprite, vec2(0.0, -0.8), 0.8);
+        hazardHandles.Reset(MAX_HAZARDS);
+        hazards.Clear();
+        hazardInfo.clear();
+        score = 0;
+        timeTillNextBox = 0.0f;
+        timeTillNextBird = 10.0f;
+    }
     
-    glClearColor(0.47, 0.85, 1.0, 1.0);
+    Handle AddHazard(HazardKind kind, const AtlasRegion *sprite, vec2 pos, float sf, vec2 vel){
+        if (hazardHandles.Full()){
+            return HandleTable::Invalid();
+        }
+        hazards.Add(pos.x, pos.y, vel.x, vel.y, sf*0.6f, sf*0.5f);
+        HazardInfo info = {kind, sprite, 0.0f};
+        hazardInfo.push_back(info);
+        return hazardHandles.Add();
+    }
     
-    #ifdef _WINDOWS
-    glewInit();
-    #endif
+    void RemoveHazard(size_t index){
+        hazardHandles.RemoveAt(index);
+        hazards.Remove(index);
+        hazardInfo[index] = hazardInfo.back();
+        hazardInfo.pop_back();
+    }
     
-    glViewport(0, 0, 375, 667);
+    //everything the simulation reads, for checking a replay ends where its recording did
+    unsigned long long Hash(GameMode mode, const BirdSprites &birdSprites) const{
+        StateHash hash;
+        hash.Add((int)mode);
+        hash.Add(score);
+        hash.Add(timeTillNextBox);
+        hash.Add(timeTillNextBird);
+        hash.Add((int)random.state);
+        hash.Add(plane.position.x);
+        hash.Add(plane.position.y);
+        hash.Add(plane.velocity.x);
+        hash.Add(plane.width);
+        hash.Add(plane.height);
+        hash.Add(hazards.positionX);
+        hash.Add(hazards.positionY);
+        hash.Add(hazards.velocityX);
+        hash.Add(hazards.velocityY);
+        hash.Add(hazards.width);
+        hash.Add(hazards.height);
+        for (size_t i = 0; i < hazardInfo.size(); i++){
+            hash.Add((int)hazardInfo[i].kind);
+            hash.Add(hazardInfo[i].timeSinceLastFlap);
+            hash.Add(BirdFrame(birdSprites, hazardInfo[i].sprite));
+        }
+        return hash.value;
+    }
     
-    Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 4096 );
+    //a hazard that blew up draws over the other hazards with the plane's explosion
+    void DrawHazards(RenderQueue &queue, ShaderProgram &program, const AtlasRegion *explosionSprite, float alpha){
+        for (size_t i = 0; i < hazards.Size(); i++){
+            const AtlasRegion *sprite = hazardInfo[i].sprite;
+            RenderLayer layer = sprite == explosionSprite ? LAYER_EFFECTS : LAYER_HAZARDS;
+            float x = hazards.previousX[i] + (hazards.positionX[i] - hazards.previousX[i])*alpha;
+            float y = hazards.previousY[i] + (hazards.positionY[i] - hazards.previousY[i])*alpha;
+            queue.SubmitQuad(layer, program, sprite->texture, 0.5f, x, y, hazards.width[i], hazards.height[i], sprite->u0, sprite->v0, sprite->u1, sprite->v1);
+        }
+    }
+    
+};
+
+void Setup(bool isHeadless){
+    if (isHeadless){
+        #ifdef HEADLESS_EGL
+        SDL_Init(SDL_INIT_TIMER);
+        #else
+        SDL_Init(SDL_INIT_VIDEO);
+        #endif
+        if (!headless.Create(375, 667)){
+            exit(1);
+        }
+    }
+    else{
+        SDL_Init(SDL_INIT_VIDEO);
+        displayWindow = SDL_CreateWindow("My Game", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 375, 667, SDL_WINDOW_OPENGL);
+        SDL_GLContext context = SDL_GL_CreateContext(displayWindow);
+        SDL_GL_MakeCurrent(displayWindow, context);
+        //the game loop simulates at a fixed rate, frames are paced by the display
+        SDL_GL_SetSwapInterval(1);
+        
+        #ifdef _WINDOWS
+        glewInit();
+        #endif
+        
+        glViewport(0, 0, 375, 667);
+        
+        Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 4096 );
+    }
+    
+    glClearColor(0.47, 0.85, 1.0, 1.0);
     
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 }
 
-void Update(float elapsed, Entity &plane, vector<Entity> &boxes, vector<Entity> &birds, unsigned int &bird1, unsigned int &bird2, unsigned int   &birdR1, unsigned int &birdR2){
+void Update(float elapsed, Entity &plane, EntityStore &hazards, vector<HazardInfo> &hazardInfo, const BirdSprites &birdSprites, JobSystem &jobs){
     
 
     plane.position.x += elapsed * plane.velocity.x;
-    for (Entity &box: boxes){
-        box.position.y += elapsed * box.velocity.y;
-    }
-    for (Entity &bird: birds){
-        bird.timeSinceLastFlap += elapsed;
-        bird.position.y += elapsed * bird.velocity.y;
-        bird.position.x += elapsed * bird.velocity.x;
-        //switch direction of bird if it hits edges of screen
-        if(bird.position.x >= 0.95){
-            bird.velocity.x = -bird.velocity.x;
-            bird.TextureID = birdR1;
-        }
-        else if(bird.position.x <= -0.95){
-            bird.velocity.x = -bird.velocity.x;
-            bird.TextureID = bird1;
-        }
-        if (bird.timeSinceLastFlap > 0.5f && bird.velocity.x > 0.0f){
-            if (bird.TextureID == bird1){
-                bird.TextureID = bird2;
-            }
-            else{
-                bird.TextureID = bird1;
-            }
-            bird.timeSinceLastFlap = 0.0;
-        }
-        else if (bird.timeSinceLastFlap > 0.5f && bird.velocity.x < 0.0f){
-            if (bird.TextureID == birdR1){
-                bird.TextureID = birdR2;
-            }
-            else{
-                bird.TextureID = birdR1;
-            }
-            bird.timeSinceLastFlap = 0.0;
-        }
-    }
+    //moves and animates every crate and bird, split across the job threads
+    UpdateHazards(elapsed, hazards, hazardInfo, birdSprites, jobs);
 }
 
 int main(int argc, char *argv[])
 {
+    //--record writes every tick's input to a file, --replay plays one back headless as fast as possible
+    const char *recordPath = RecordPath(argc, argv);
+    const char *replayPath = ReplayPath(argc, argv);
+    Replay replay;
+    Replay recording;
+    if (replayPath != NULL && !replay.Load(replayPath)){
+        return 1;
+    }
+    bool isReplay = replayPath != NULL;
     
-    Setup();
-    GLuint planeTex = LoadTexture(RESOURCE_FOLDER"Plane.png");
-    GLuint crateTex = LoadTexture(RESOURCE_FOLDER"crate.png");
-    GLuint cloudTex1 = LoadTexture(RESOURCE_FOLDER"cloud.png");
-    GLuint cloudTex2 = LoadTexture(RESOURCE_FOLDER"cloud2.png");
-    GLuint bird1Tex = LoadTexture(RESOURCE_FOLDER"bird.png");
-    GLuint bird2Tex = LoadTexture(RESOURCE_FOLDER"bird2.png");
-    GLuint bird1RTex = LoadTexture(RESOURCE_FOLDER"birdR1.png");
-    GLuint bird2RTex = LoadTexture(RESOURCE_FOLDER"birdR2.png");
-    GLuint fontTex = LoadTexture(RESOURCE_FOLDER"font1.png");
-    GLuint explosionTex = LoadTexture(RESOURCE_FOLDER"explosion.png");
-    GLuint rightArrowTex = LoadTexture(RESOURCE_FOLDER"arrowRight.png");
-    GLuint leftArrowTex = LoadTexture(RESOURCE_FOLDER"arrowLeft.png");
+    //--headless renders offscreen for --frames frames and reports frame times
+    bool isHeadless = IsHeadless(argc, argv) || isReplay;
+    int headlessFrames = HeadlessFrameCount(argc, argv, 600);
     
-    const Uint8 *keys = SDL_GetKeyboardState(NULL);
-    GameMode mode = START_SCREEN;
-    GameState state = GameState(planeTex, crateTex);
+    Uint64 launch = SDL_GetPerformanceCounter();
+    Setup(isHeadless);
+    
+    //images and sounds decode on worker threads while the loading screen draws
+    AssetLoader loader;
+    GLuint atlasTexture = 0;
+    Mix_Music *backgroundMusic = NULL;
+    Mix_Chunk *crashSound = NULL;
+    loader.QueueTexture(RESOURCE_FOLDER"sprites.ktx", &atlasTexture, GL_LINEAR);
+    loader.QueueMusic(RESOURCE_FOLDER"music.mp3", &backgroundMusic);
+    loader.QueueSound(RESOURCE_FOLDER"Explosion.wav", &crashSound);
+    loader.Start();
     
     ShaderProgram program;
     program.Load(RESOURCE_FOLDER"vertex_textured.glsl", RESOURCE_FOLDER"fragment_textured.glsl");
-    glUseProgram(program.programID);
+    program.Use();
+    
+    SpriteBatch batch;
+    batch.Load();
+    RenderQueue queue;
     
     glm::mat4 projectionMatrix = glm::mat4(1.0f);
     glm::mat4 viewMatrix = glm::mat4(1.0f);
@@ -263,34 +291,163 @@ int main(int argc, char *argv[])
 
     program.SetProjectionMatrix(projectionMatrix);
     
-    Entity arrowRight = Entity(rightArrowTex, vec2(0.5, -0.8), 0.3);
-    Entity arrowLeft = Entity(leftArrowTex, vec2(-0.5, -0.8), 0.3);
-    Entity cloud1 = Entity(cloudTex1, vec2(-0.7, 1.0));
-    Entity cloud2 = Entity(cloudTex2, vec2(0.5, -0.3));
+    //a progress bar goes up on the first frame and fills as assets arrive
+    SDL_Event event;
+    bool done = false;
+    GLuint whiteTexture = CreateWhiteTexture();
+    double firstFrameTime = 0.0;
+    //sprites missing from the packed atlas are queued from their own png once the atlas is in, so the game
+    //still starts when sprites.ktx has not been cooked or AtlasPacker has not been run over every sprite
+    TextureManager textures;
+    TextureAtlas atlas;
+    GLuint spriteTextures[SPRITE_COUNT] = {0};
+    bool atlasChecked = false;
+    while (!done && !(atlasChecked && loader.Done())) {
+        while (SDL_PollEvent(&event)) {
+            if (event.type == SDL_QUIT || event.type == SDL_WINDOWEVENT_CLOSE) {
+                done = true;
+            }
+        }
+        float progress = loader.Progress();
+        queue.Clear();
+        queue.SubmitQuad(LAYER_UI, program, whiteTexture, 0.5f, -0.8f + 0.8f*progress, 0.0f, 1.6f*progress, 0.05f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        queue.Execute(batch);
+        if (isHeadless){
+            headless.EndFrame();
+        }
+        else{
+            SDL_GL_SwapWindow(displayWindow);
+        }
+        if (firstFrameTime == 0.0){
+            firstFrameTime = MillisecondsSince(launch);
+        }
+        //uploads after the swap, so a finished image never holds up the frame already drawn
+        loader.Update();
+        if (!atlasChecked && loader.Done()){
+            atlasChecked = true;
+            //the loader uploaded the atlas, the texture manager owns it from here on
+            if (atlasTexture != 0){
+                Handle atlasHandle = textures.Adopt(RESOURCE_FOLDER"sprites.ktx", atlasTexture, GL_LINEAR);
+                atlas.Load(textures.Get(atlasHandle), RESOURCE_FOLDER"sprites.atlas");
+            }
+            for (int i = 0; i < SPRITE_COUNT; i++){
+                if (!atlas.HasRegion(spriteNames[i])){
+                    loader.QueueTexture(SpritePath(spriteNames[i]).c_str(), &spriteTextures[i], GL_LINEAR);
+                }
+            }
+        }
+    }
+    glDeleteTextures(1, &whiteTexture);
+    loader.Cleanup();
+    for (int i = 0; i < SPRITE_COUNT; i++){
+        if (spriteTextures[i] != 0){
+            Handle image = textures.Adopt(SpritePath(spriteNames[i]).c_str(), spriteTextures[i], GL_LINEAR);
+            const ManagedTexture *info = textures.Info(image);
+            atlas.AddImage(spriteNames[i], textures.Get(image), info != NULL ? info->width : 0, info != NULL ? info->height : 0);
+        }
+        else if (!atlas.HasRegion(spriteNames[i])){
+            //the loader already reported the png, the sprite draws without a texture
+            atlas.AddImage(spriteNames[i], 0, 0, 0);
+        }
+    }
+    if (done){
+        textures.Cleanup();
+        batch.Cleanup();
+        SDL_Quit();
+        return 0;
+    }
+    std::cout << "first frame after " << firstFrameTime << " ms, assets ready after " << MillisecondsSince(launch) << " ms" << std::endl;
+    
+    const AtlasRegion *planeSprite = &atlas.GetRegion("Plane");
+    const AtlasRegion *crateSprite = &atlas.GetRegion("crate");
+    const AtlasRegion *cloudSprite1 = &atlas.GetRegion("cloud");
+    const AtlasRegion *cloudSprite2 = &atlas.GetRegion("cloud2");
+    const AtlasRegion *bird1Sprite = &atlas.GetRegion("bird");
+    const AtlasRegion *bird2Sprite = &atlas.GetRegion("bird2");
+    const AtlasRegion *bird1RSprite = &atlas.GetRegion("birdR1");
+    const AtlasRegion *bird2RSprite = &atlas.GetRegion("birdR2");
+    const AtlasRegion &font = atlas.GetRegion("font1");
+    const AtlasRegion *explosionSprite = &atlas.GetRegion("explosion");
+    const AtlasRegion *rightArrowSprite = &atlas.GetRegion("arrowRight");
+    const AtlasRegion *leftArrowSprite = &atlas.GetRegion("arrowLeft");
+    BirdSprites birdSprites = {bird1Sprite, bird2Sprite, bird1RSprite, bird2RSprite};
     
-    Mix_Music *backgroundMusic;
-    backgroundMusic = Mix_LoadMUS(RESOURCE_FOLDER"music.mp3");
-    Mix_PlayMusic(backgroundMusic, -1);
+    const Uint8 *keys = SDL_GetKeyboardState(NULL);
+    GameMode mode = isHeadless ? GAME_ON : START_SCREEN;
+    GameState state = GameState(planeSprite);
+    //headless runs keep a fixed seed so their timings stay comparable
+    state.random.Seed(isHeadless ? 1 : (unsigned int)time(NULL));
+    if (isReplay){
+        mode = (GameMode)replay.startMode;
+        state.random.Seed(replay.seed);
+    }
+    if (recordPath != NULL){
+        recording.Begin(state.random.state, (unsigned char)mode);
+    }
     
-    Mix_Chunk *crashSound;
-    crashSound = Mix_LoadWAV(RESOURCE_FOLDER"Explosion.wav");
+    //hazards near the plane, rebuilt every tick so only those are tested
+    //the screen is about 4x8 cells, so a few buckets are plenty
+    SpatialHash broadphase(0.5f, 64);
+    vector<size_t> candidates;
     
-    SDL_Event event;
-    bool done = false;
-    float lastframeTicks = 0.0;
+    //one thread per core for updating and bucketing hazards
+    JobSystem jobs;
+    
+    //F1 toggles the timing overlay
+    Profiler profiler;
+    profiler.Load(font);
+    
+    TextCache textCache;
+    TextLabel scoreLabel;
+    scoreLabel.Setup(font, 0.35f, -0.11f);
+    
+    //the constant labels are looked up once, every Get builds a string key
+    TextLabel &planeLabel = textCache.Get(font, "Plane", 0.35, -0.11);
+    TextLabel &gliderLabel = textCache.Get(font, "Glider", 0.35, -0.11);
+    TextLabel &startLabel = textCache.Get(font, "(move left or right to start)", 0.1, -0.045);
+    TextLabel &gameOverLabel = textCache.Get(font, "Game Over", 0.2f, -0.05f);
+    TextLabel &restartLabel = textCache.Get(font, "press R to play again", 0.1f, -0.02f);
+    TextLabel &exitLabel = textCache.Get(font, "or press esc to exit", 0.1f, -0.01f);
+    
+    Entity arrowRight = Entity(rightArrowSprite, vec2(0.5, -0.8), 0.3);
+    Entity arrowLeft = Entity(leftArrowSprite, vec2(-0.5, -0.8), 0.3);
+    Entity cloud1 = Entity(cloudSprite1, vec2(-0.7, 1.0));
+    Entity cloud2 = Entity(cloudSprite2, vec2(0.5, -0.3));
+    
+    Mix_PlayMusic(backgroundMusic, -1);
+    
+    //simulation runs at 120 Hz whatever the display rate is
+    GameLoop loop(120.0f);
+    FrameTimes frameTimes;
+    frameTimes.Reserve(headlessFrames);
+    int frameCount = 0;
     float elapsedAn = 0.0;
     bool isDrawn = false;
+    Uint64 runStart = SDL_GetPerformanceCounter();
     while (!done) {
         
-        float ticks = (float)SDL_GetTicks()/1000.0;
-        float elapsed = ticks - lastframeTicks;
-        lastframeTicks = ticks;
+        frameTimes.BeginFrame();
+        profiler.BeginFrame();
         
+        //headless runs feed the loop 60 Hz frames regardless of how fast they render, replays skip the clock entirely
+        int steps;
+        if (isReplay){
+            steps = (int)min(replay.RemainingTicks(), (unsigned int)REPLAY_TICKS_PER_FRAME);
+        }
+        else{
+            steps = isHeadless ? loop.BeginFrame(1.0f/60.0f) : loop.BeginFrame();
+        }
+        float elapsed = isReplay ? steps * loop.timestep : loop.frameTime;
         
+        profiler.BeginPhase(PHASE_EVENTS);
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_KEYDOWN){
+                if(event.key.keysym.scancode == SDL_SCANCODE_F1){
+                    profiler.visible = !profiler.visible;
+                }
                 if(event.key.keysym.scancode == SDL_SCANCODE_ESCAPE && (mode == GAME_OVER || mode == START_SCREEN)){
-                    SDL_Quit();
+                    //SDL_Quit waits for the end of main, the cleanup below still needs the context
                     done = true;
                     Mix_FreeMusic(backgroundMusic);
                     Mix_FreeChunk(crashSound);
@@ -303,126 +460,157 @@ int main(int argc, char *argv[])
             }
         }
         //process events;2
+        //the keys are read once a frame and applied by every tick, which is what gets recorded
+        unsigned char input = 0;
         if (keys[SDL_SCANCODE_LEFT]){
-            if (mode == START_SCREEN){
-                mode = GAME_ON;
-            }
-            state.plane.velocity.x = -1.5;
+            input |= INPUT_LEFT;
         }
         else if (keys[SDL_SCANCODE_RIGHT]){
-            if (mode == START_SCREEN){
-                mode = GAME_ON;
-            }
-        
-            state.plane.velocity.x = 1.5f;
+            input |= INPUT_RIGHT;
         }
-        else{
-            state.plane.velocity.x = 0.0f;
+        if (keys[SDL_SCANCODE_R] || isHeadless){
+            input |= INPUT_RESTART;
         }
+        profiler.EndPhase(PHASE_EVENTS);
         
-        if (mode == GAME_OVER && keys[SDL_SCANCODE_R]){
-            mode = GAME_ON;
-            state = GameState(planeTex, crateTex);
-            Mix_ResumeMusic();
-        }
-        
-        glClear(GL_COLOR_BUFFER_BIT);
-        
-        state.plane.Draw(program);
-        cloud1.Draw(program);
-        cloud2.Draw(program);
-        
-        switch (mode) {
-        case START_SCREEN:
-            if(elapsedAn > 0.5){
-                isDrawn = !isDrawn;
-                elapsedAn = 0.0;
+        //runs as many fixed steps as the loop owes, the simulation only moves while playing
+        for (int step = 0; step < steps; step++){
+            unsigned char tickInput = isReplay ? replay.NextInput() : input;
+            if (recordPath != NULL){
+                recording.AddTick(tickInput);
+            }
+            if (tickInput & INPUT_LEFT){
+                if (mode == START_SCREEN){
+                    mode = GAME_ON;
+                }
+                state.plane.velocity.x = -1.5;
+            }
+            else if (tickInput & INPUT_RIGHT){
+                if (mode == START_SCREEN){
+                    mode = GAME_ON;
+                }
+                state.plane.velocity.x = 1.5f;
             }
             else{
-                elapsedAn += elapsed;
+                state.plane.velocity.x = 0.0f;
             }
-            
-            DrawText(program, fontTex, "Plane", 0.35, -0.11, -0.45, 1.4);
-            DrawText(program, fontTex, "Glider", 0.35, -0.11, -0.55, 1.0);
-        
-            DrawText(program, fontTex, "(move left or right to start)", 0.1, -0.045, -0.7, -1.3);
-            
-            if (isDrawn){
-                arrowLeft.Draw(program);
-                arrowRight.Draw(program);
+            if (mode == GAME_OVER && (tickInput & INPUT_RESTART)){
+                mode = GAME_ON;
+                state.Reset(planeSprite);
+                Mix_ResumeMusic();
+            }
+            if (mode != GAME_ON){
+                continue;
             }
-        
-        break;
-        
-        case GAME_ON:
-            state.timeTillNextBox -= elapsed;
-            state.timeTillNextBird -= elapsed;
             
+            profiler.BeginPhase(PHASE_UPDATE);
+            state.plane.previousPosition = state.plane.position;
+            state.hazards.SavePrevious();
+            state.timeTillNextBox -= loop.timestep;
+            state.timeTillNextBird -= loop.timestep;
+        
              if (state.timeTillNextBox <= 0.0f){
                 //spawn box
-                float randomX = (float)(rand() % 200 - 100)/100.0;
-                Entity box = Entity(crateTex, vec2(randomX, screenHeight), 1.0f, vec2(0.0, -0.7));
-                state.boxes.push_back(box);
+                float randomX = (float)(state.random.Range(200) - 100)/100.0;
+                state.AddHazard(HAZARD_BOX, crateSprite, vec2(randomX, screenHeight), 1.0f, vec2(0.0, -0.7));
                 state.timeTillNextBox = 2.0f;
             }
-            
+        
             if(state.timeTillNextBird <= 0.0f){
-                Entity bird = Entity(bird1Tex, vec2(0.0, screenHeight), 0.7f, vec2(0.3, -0.4));
-                state.birds.push_back(bird);
+                state.AddHazard(HAZARD_BIRD, bird1Sprite, vec2(0.0, screenHeight), 0.7f, vec2(0.3, -0.4));
                 state.timeTillNextBird = 6.0f;
             }
+    
+            Update(loop.timestep, state.plane, state.hazards, state.hazardInfo, birdSprites, jobs);
         
-            Update(elapsed, state.plane, state.boxes, state.birds, bird1Tex, bird2Tex, bird1RTex, bird2RTex);
-            
              if(state.plane.position.x > 1.05f){
                 state.plane.position.x = -1.05f;
+                state.plane.previousPosition.x = -1.05f;
              }
             else if(state.plane.position.x < -1.05f){
                 state.plane.position.x = 1.05f;
+                state.plane.previousPosition.x = 1.05f;
             }
-            
-            for (Entity &box: state.boxes){
-                if (box.position.y < -screenHeight - 0.2){
-                    state.boxes.erase(state.boxes.begin());
-                    state.score += 1;
-                }
-                if (state.plane.didCollideWith(box)){
+            profiler.EndPhase(PHASE_UPDATE);
+        
+            profiler.BeginPhase(PHASE_COLLISION);
+            broadphase.Build(state.hazards, jobs);
+            //grow the plane's box by as far as it and any hazard moved this step
+            float reach = 2.0f * loop.timestep * (abs(state.plane.velocity.x) + state.hazards.MaxSpeed());
+            broadphase.Query(state.plane.position.x, state.plane.position.y, state.plane.width + reach, state.plane.height + reach, candidates);
+            Handle crashedInto = HandleTable::Invalid();
+            for (size_t i: candidates){
+                if (state.plane.didCollideWith(state.hazards, i, loop.timestep)){
                     mode = GAME_OVER;
-                    state.plane.TextureID = explosionTex;
+                    state.plane.sprite = explosionSprite;
+                    crashedInto = state.hazardHandles.HandleAt(i);
                     Mix_PlayChannel(1, crashSound, 0);
                 }
-                box.Draw(program);
-                
             }
-            for (Entity &bird: state.birds){
-                if (bird.position.y < -screenHeight - 0.2){
-                    state.birds.erase(state.birds.begin());
-                }
-                if (state.plane.didCollideWith(bird)){
-                    mode = GAME_OVER;
-                    state.plane.TextureID = explosionTex;
-                    Mix_PlayChannel(1, crashSound, 0);
+            //walk backwards so removing a hazard only moves ones already checked
+            for (size_t i = state.hazards.Size(); i-- > 0;){
+                if (state.hazards.positionY[i] < -screenHeight - 0.2){
+                    if (state.hazardInfo[i].kind == HAZARD_BOX){
+                        state.score += 1;
+                    }
+                    state.RemoveHazard(i);
                 }
-                bird.Draw(program);
-                
             }
+            //the hazard that was hit blows up too, found by handle since removals above may have moved it
+            if (state.hazardHandles.IsValid(crashedInto)){
+                state.hazardInfo[state.hazardHandles.IndexOf(crashedInto)].sprite = explosionSprite;
+            }
+            profiler.EndPhase(PHASE_COLLISION);
+        }
+        
+        batch.ResetStats();
+        ShaderProgram::ResetStats();
+        queue.Clear();
+        
+        //the plane and hazards only move while playing
+        float alpha = mode == GAME_ON && !isReplay ? loop.Alpha() : 1.0f;
+        state.plane.Draw(queue, program, state.plane.sprite == explosionSprite ? LAYER_EFFECTS : LAYER_PLANE, alpha);
+        cloud1.Draw(queue, program, LAYER_CLOUDS);
+        cloud2.Draw(queue, program, LAYER_CLOUDS);
+        
+        switch (mode) {
+        case START_SCREEN:
+            if(elapsedAn > 0.5){
+                isDrawn = !isDrawn;
+                elapsedAn = 0.0;
+            }
+            else{
+                elapsedAn += elapsed;
+            }
+            
+            if (isDrawn){
+                arrowLeft.Draw(queue, program, LAYER_UI);
+                arrowRight.Draw(queue, program, LAYER_UI);
+            }
+            
+            queue.SubmitText(LAYER_TEXT, program, planeLabel, -0.45, 1.4);
+            queue.SubmitText(LAYER_TEXT, program, gliderLabel, -0.55, 1.0);
+        
+            queue.SubmitText(LAYER_TEXT, program, startLabel, -0.7, -1.3);
+        
+        break;
+        
+        case GAME_ON:
+            state.DrawHazards(queue, program, explosionSprite, alpha);
             
-            DrawText(program, fontTex, to_string(state.score), 0.35f, -0.11f, 0.0f, 1.5f);
+            scoreLabel.SetText(to_string(state.score));
+            queue.SubmitText(LAYER_TEXT, program, scoreLabel, 0.0f, 1.5f);
             
         break;
         
         case GAME_OVER:
         
-            for (Entity &box: state.boxes){
-                box.Draw(program);
-            }
-            for (Entity &bird: state.birds){
-                bird.Draw(program);
-            }
-            DrawText(program, fontTex, "Game Over", 0.2f, -0.05f, -0.6f, 0.6f);
-            DrawText(program, fontTex, "press R to play again", 0.1f, -0.02f, -0.8f, 0.0f);
-            DrawText(program, fontTex, "or press esc to exit", 0.1f, -0.01f, -0.8f, -0.2f);
-            DrawText(program, fontTex, to_string(state.score), 0.35f, -0.11f, 0.0f, 1.5f);
+            state.DrawHazards(queue, program, explosionSprite, alpha);
+            queue.SubmitText(LAYER_TEXT, program, gameOverLabel, -0.6f, 0.6f);
+            queue.SubmitText(LAYER_TEXT, program, restartLabel, -0.8f, 0.0f);
+            queue.SubmitText(LAYER_TEXT, program, exitLabel, -0.8f, -0.2f);
+            scoreLabel.SetText(to_string(state.score));
+            queue.SubmitText(LAYER_TEXT, program, scoreLabel, 0.0f, 1.5f);
             
             Mix_PauseMusic();
             
@@ -431,9 +619,65 @@ int main(int argc, char *argv[])
         break;
         }
 
-        SDL_GL_SwapWindow(displayWindow);
+        profiler.DrawOverlay(queue, program);
+        
+        profiler.BeginPhase(PHASE_DRAW);
+        glClear(GL_COLOR_BUFFER_BIT);
+        queue.Execute(batch);
+        profiler.EndPhase(PHASE_DRAW);
+        profiler.drawCalls = queue.drawCalls;
+        profiler.entityCount = 1 + (int)state.hazards.Size();
+        profiler.vertexCount = batch.vertexCount;
+        profiler.bindsUnsorted = queue.bindsUnsorted;
+        profiler.bindsSorted = queue.bindsSorted;
+        profiler.programSwitchesUnsorted = queue.programSwitchesUnsorted;
+        profiler.programSwitchesSorted = queue.programSwitchesSorted;
+        profiler.glCallsIssued = ShaderProgram::issuedCalls;
+        profiler.glCallsAvoided = ShaderProgram::avoidedCalls;
+        
+        profiler.BeginPhase(PHASE_SWAP);
+        if (isHeadless){
+            headless.EndFrame();
+            frameTimes.EndFrame();
+            frameCount++;
+            if (isReplay ? replay.Finished() : frameCount >= headlessFrames){
+                done = true;
+            }
+        }
+        else{
+            SDL_GL_SwapWindow(displayWindow);
+        }
+        loop.EndFrame();
+        profiler.EndPhase(PHASE_SWAP);
+        profiler.EndFrame();
     }
     
+    if (isHeadless){
+        frameTimes.Report("Final Project");
+        profiler.Report();
+        textures.PrintUsage();
+    }
+    
+    unsigned long long finalHash = state.Hash(mode, birdSprites);
+    if (recordPath != NULL && recording.Save(recordPath, finalHash)){
+        std::cout << "recorded " << recording.tickCount << " ticks to " << recordPath << std::endl;
+    }
+    bool replayMatched = true;
+    if (isReplay){
+        double seconds = (double)(SDL_GetPerformanceCounter() - runStart) / (double)SDL_GetPerformanceFrequency();
+        std::cout << "replayed " << replay.tickCount << " ticks in " << seconds << " s (" << replay.tickCount / seconds << " ticks/s)" << std::endl;
+        replayMatched = finalHash == replay.finalHash;
+        std::cout << (replayMatched ? "final state matches the recording" : "final state differs from the recording") << std::endl;
+    }
+    
+    batch.Cleanup();
+    scoreLabel.Cleanup();
+    textCache.Cleanup();
+    profiler.Cleanup();
+    textures.Cleanup();
+    if (isHeadless){
+        headless.Destroy();
+    }
     SDL_Quit();
-    return 0;
+    return replayMatched ? 0 : 1;
 }
@@ -8,6 +8,7 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 #include "ShaderProgram.h"
+#include "TextureManager.h"
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #ifdef _WINDOWS
@@ -18,22 +19,6 @@
 
 SDL_Window* displayWindow;
 
-GLuint LoadTexture(const char *filePath) {
-    int w,h,comp;
-    unsigned char* image = stbi_load(filePath, &w, &h, &comp, STBI_rgb_alpha);
-    if(image == NULL) {
-        std::cout << "Unable to load image. Make sure the path is correct\n";
-        assert(false);
-    }
-    GLuint retTexture;
-    glGenTextures(1, &retTexture);
-    glBindTexture(GL_TEXTURE_2D, retTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    stbi_image_free(image);
-    return retTexture;
-}
 int main(int argc, char *argv[])
 {
     SDL_Init(SDL_INIT_VIDEO);
@@ -52,9 +37,10 @@ int main(int argc, char *argv[])
     ShaderProgram programUntextured;
     programUntextured.Load(RESOURCE_FOLDER"vertex.glsl", RESOURCE_FOLDER"fragment.glsl");
     
-    GLuint alienTexture = LoadTexture(RESOURCE_FOLDER"alien.png");
-    GLuint planeTexture = LoadTexture(RESOURCE_FOLDER"plane.png");
-    GLuint alertTexture = LoadTexture(RESOURCE_FOLDER"alert-icon.png");
+    TextureManager textures;
+    GLuint alienTexture = textures.Get(textures.Acquire(RESOURCE_FOLDER"alien.png", GL_LINEAR));
+    GLuint planeTexture = textures.Get(textures.Acquire(RESOURCE_FOLDER"plane.png", GL_LINEAR));
+    GLuint alertTexture = textures.Get(textures.Acquire(RESOURCE_FOLDER"alert-icon.png", GL_LINEAR));
     
     glm::mat4 projectionMatrix = glm::mat4(1.0f);
     glm::mat4 modelMatrix = glm::mat4(1.0f);
@@ -63,8 +49,8 @@ int main(int argc, char *argv[])
     projectionMatrix = glm::ortho(-1.777f, 1.777f, -1.0f, 1.0f, -1.0f, 1.0f);
     
     
-    glUseProgram(programUntextured.programID);
-    glUseProgram(programTextured.programID);
+    programUntextured.Use();
+    programTextured.Use();
     
     
     glClearColor(0.7f, 0.2f, 0.4f, 1.0f); //sets background color
@@ -176,6 +162,7 @@ int main(int argc, char *argv[])
     
 
     }
+    textures.Cleanup();
     SDL_Quit();
     return 0;
 }
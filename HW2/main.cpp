@@ -35,7 +35,7 @@ void Render(const float &rightPaddleY, const float &leftPaddleY, const float &ba
 
     ShaderProgram program;
     program.Load(RESOURCE_FOLDER"vertex.glsl", RESOURCE_FOLDER"fragment.glsl");
-    glUseProgram(program.programID);
+    program.Use();
     
     //draw the ball in the center
     glm::mat4 projectionMatrix = glm::mat4(1.0f);
@@ -0,0 +1,67 @@
+#include "CollisionGrid.h"
+#include <cmath>
+#include <algorithm>
+
+CollisionGrid::CollisionGrid(): originX(0.0f), originY(0.0f), cellWidth(1.0f), cellHeight(1.0f), columns(0), rows(0) {}
+
+void CollisionGrid::Reset(float originX, float originY, float cellWidth, float cellHeight, int columns, int rows) {
+    this->originX = originX;
+    this->originY = originY;
+    this->cellWidth = cellWidth;
+    this->cellHeight = cellHeight;
+    this->columns = columns;
+    this->rows = rows;
+    cellHead.assign(columns * rows, -1);
+    entryNext.clear();
+    entryItem.clear();
+}
+
+int CollisionGrid::Column(float x) const {
+    return (int)floorf((x - originX) / cellWidth);
+}
+
+int CollisionGrid::Row(float y) const {
+    return (int)floorf((y - originY) / cellHeight);
+}
+
+void CollisionGrid::Insert(unsigned int item, float x, float y, float halfWidth, float halfHeight) {
+    int minColumn = std::max(0, Column(x - halfWidth));
+    int maxColumn = std::min(columns - 1, Column(x + halfWidth));
+    int minRow = std::max(0, Row(y - halfHeight));
+    int maxRow = std::min(rows - 1, Row(y + halfHeight));
+    for (int row = minRow; row <= maxRow; row++) {
+        for (int column = minColumn; column <= maxColumn; column++) {
+            int cell = row * columns + column;
+            entryItem.push_back(item);
+            entryNext.push_back(cellHead[cell]);
+            cellHead[cell] = (int)entryItem.size() - 1;
+        }
+    }
+}
+
+void CollisionGrid::QueryBox(float x, float y, float halfWidth, float halfHeight, std::vector<unsigned int> &items) const {
+    items.clear();
+    int minColumn = std::max(0, Column(x - halfWidth));
+    int maxColumn = std::min(columns - 1, Column(x + halfWidth));
+    int minRow = std::max(0, Row(y - halfHeight));
+    int maxRow = std::min(rows - 1, Row(y + halfHeight));
+    for (int row = minRow; row <= maxRow; row++) {
+        for (int column = minColumn; column <= maxColumn; column++) {
+            for (int entry = cellHead[row * columns + column]; entry != -1; entry = entryNext[entry]) {
+                items.push_back(entryItem[entry]);
+            }
+        }
+    }
+}
+
+void CollisionGrid::Query(float x, float y, std::vector<unsigned int> &items) const {
+    items.clear();
+    int column = Column(x);
+    int row = Row(y);
+    if (column < 0 || column >= columns || row < 0 || row >= rows) {
+        return;
+    }
+    for (int entry = cellHead[row * columns + column]; entry != -1; entry = entryNext[entry]) {
+        items.push_back(entryItem[entry]);
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+// Fixed grid of cells laid over the invader formation. Items are inserted into
+// every cell their box touches, so a point only has to be tested against the
+// items of the one cell it falls in. Cells keep singly linked lists threaded
+// through shared arrays, so rebuilding each frame does not allocate once the
+// arrays have grown to the formation size.
+class CollisionGrid {
+    public:
+
+        CollisionGrid();
+
+        // empties the grid and lays columns x rows cells starting at the bottom left corner
+        void Reset(float originX, float originY, float cellWidth, float cellHeight, int columns, int rows);
+        void Insert(unsigned int item, float x, float y, float halfWidth, float halfHeight);
+        // items whose box touches the cell containing the point
+        void Query(float x, float y, std::vector<unsigned int> &items) const;
+        // items touching any cell the box overlaps, an item can be listed more than once
+        void QueryBox(float x, float y, float halfWidth, float halfHeight, std::vector<unsigned int> &items) const;
+
+        float originX;
+        float originY;
+        float cellWidth;
+        float cellHeight;
+        int columns;
+        int rows;
+
+    private:
+
+        int Column(float x) const;
+        int Row(float y) const;
+
+        std::vector<int> cellHead;
+        std::vector<int> entryNext;
+        std::vector<unsigned int> entryItem;
+};
@@ -0,0 +1,38 @@
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+#include "Entity.h"
+#include "ShaderProgram.h"
+#include "glm/mat4x4.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+void Entity::Draw(ShaderProgram &program){
+    #define DEFAULT_VERTICES {-0.5, -0.5, 0.5, -0.5, 0.5, 0.5,-0.5, -0.5, 0.5, 0.5, -0.5, 0.5}
+    
+    glBindTexture(GL_TEXTURE_2D, textureID);
+
+    glm::mat4 modelMatrix = glm::mat4(1.0f);
+   
+    modelMatrix = glm::translate(modelMatrix, glm::vec3(xPos, yPos, 0.0f));
+    modelMatrix = glm::scale(modelMatrix, glm::vec3(scaleFactor*width, scaleFactor*height, 1.0f));
+
+    program.SetModelMatrix(modelMatrix);
+
+    float vertices[] = DEFAULT_VERTICES;
+
+    glVertexAttribPointer(program.positionAttribute, 2, GL_FLOAT, false, 0, vertices);
+    glEnableVertexAttribArray(program.positionAttribute);
+
+    float textCoords[] = {u, v + height, u + width, v + height, u + width, v, u, v + height, u + width, v, u, v};
+
+    glVertexAttribPointer(program.texCoordAttribute, 2, GL_FLOAT, false, 0, textCoords);
+    glEnableVertexAttribArray(program.texCoordAttribute);
+
+
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    
+    glDisableVertexAttribArray(program.positionAttribute);
+    glDisableVertexAttribArray(program.texCoordAttribute);
+
+}
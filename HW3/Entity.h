@@ -0,0 +1,28 @@
+#pragma once
+
+class ShaderProgram;
+
+// An invader, bullet or the ship. The simulation only reads the position,
+// velocity and lifetime, drawing lives in Entity.cpp so the game logic can be
+// built without GL.
+class Entity{
+ public:
+    int textureID;
+    float xPos;
+    float yPos;
+    // where MarchInvaders found an invader, so collisions sweep the path it took
+    float xPrevious;
+    float yPrevious;
+    float xVelocity;
+    float yVelocity;
+    float height;
+    float width;
+    float u;
+    float v;
+    float timeAlive = 0.0f;
+    float scaleFactor;
+ 
+    Entity(unsigned int texture, float xPos, float yPos, float xVel, float yVel, float h, float w, float u, float v, float scaleFactor) : textureID(texture), xPos(xPos), yPos(yPos), xPrevious(xPos), yPrevious(yPos), xVelocity(xVel), yVelocity(yVel), height(h), width(w), u(u), v(v), scaleFactor(scaleFactor) {}
+ 
+    void Draw(ShaderProgram &program);
+};
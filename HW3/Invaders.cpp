@@ -0,0 +1,131 @@
+#include "Invaders.h"
+#include "SweptCollision.h"
+#include <cmath>
+#include <algorithm>
+
+bool MarchInvaders(Pool<Entity> &invaders, float elapsed, float shipY) {
+    bool reachedShip = false;
+    // recorded before anything moves, a turnaround shifts the whole formation
+    for (size_t i = 0; i < invaders.Size(); i++) {
+        invaders[i].xPrevious = invaders[i].xPos;
+        invaders[i].yPrevious = invaders[i].yPos;
+    }
+    for (size_t i = 0; i < invaders.Size(); i++) {
+        if (invaders[i].xPos > 1.7) {
+            for (size_t j = 0; j < invaders.Size(); j++) {
+                invaders[j].xVelocity = -invaders[j].xVelocity;
+                invaders[j].xPos -= 0.01;
+                invaders[j].yPos -= 0.1;
+            }
+        }
+        else if (invaders[i].xPos < -1.7) {
+            for (size_t j = 0; j < invaders.Size(); j++) {
+                invaders[j].xVelocity = -invaders[j].xVelocity;
+                invaders[j].xPos += 0.01;
+                invaders[j].yPos -= 0.1;
+            }
+        }
+        invaders[i].xPos += elapsed * invaders[i].xVelocity;
+        if (invaders[i].yPos <= shipY) {
+            reachedShip = true;
+        }
+    }
+    return reachedShip;
+}
+
+void UpdateBullets(Pool<Entity> &bullets, float elapsed) {
+    // walk backwards so despawning a bullet only moves ones already updated
+    for (size_t i = bullets.Size(); i-- > 0;) {
+        bullets[i].yPos += elapsed * bullets[i].yVelocity;
+        bullets[i].timeAlive += elapsed;
+        if (bullets[i].timeAlive > 2.0) {
+            bullets.DespawnAt(i);
+        }
+    }
+}
+
+int BulletCollisions::Check(Pool<Entity> &invaders, Pool<Entity> &bullets, float elapsed) {
+    BuildGrid(invaders);
+    return TestBullets(invaders, bullets, elapsed);
+}
+
+void BulletCollisions::BuildGrid(Pool<Entity> &invaders) {
+    if (invaders.Size() == 0) {
+        grid.Reset(0.0f, 0.0f, 1.0f, 1.0f, 0, 0);
+        invaderHit.clear();
+        return;
+    }
+    
+    // the grid covers every invader's box where it started and ended the frame
+    float minX = invaders[0].xPos, maxX = invaders[0].xPos;
+    float minY = invaders[0].yPos, maxY = invaders[0].yPos;
+    for (size_t i = 0; i < invaders.Size(); i++) {
+        minX = std::min(minX, std::min(invaders[i].xPos, invaders[i].xPrevious));
+        maxX = std::max(maxX, std::max(invaders[i].xPos, invaders[i].xPrevious));
+        minY = std::min(minY, std::min(invaders[i].yPos, invaders[i].yPrevious));
+        maxY = std::max(maxY, std::max(invaders[i].yPos, invaders[i].yPrevious));
+    }
+    float originX = minX - INVADER_HIT_HALF_WIDTH;
+    float originY = minY - INVADER_HIT_HALF_HEIGHT;
+    float width = maxX - minX + INVADER_HIT_HALF_WIDTH * 2.0f;
+    float height = maxY - minY + INVADER_HIT_HALF_HEIGHT * 2.0f;
+    // about one invader per cell however many there are and however tightly they
+    // are packed, but no smaller than a box so an invader lands in at most four cells
+    float cellSize = sqrtf(width * height / invaders.Size());
+    float cellWidth = std::max(cellSize, INVADER_HIT_HALF_WIDTH * 2.0f);
+    float cellHeight = std::max(cellSize, INVADER_HIT_HALF_HEIGHT * 2.0f);
+    int columns = (int)(width/cellWidth) + 1;
+    int rows = (int)(height/cellHeight) + 1;
+    grid.Reset(originX, originY, cellWidth, cellHeight, columns, rows);
+    invaderHit.assign(invaders.Size(), 0);
+    for (size_t i = 0; i < invaders.Size(); i++) {
+        // cover the stretch the invader marched over this frame as well
+        Entity &invader = invaders[i];
+        float marchX = fabsf(invader.xPos - invader.xPrevious)/2.0f;
+        float marchY = fabsf(invader.yPos - invader.yPrevious)/2.0f;
+        grid.Insert((unsigned int)i, (invader.xPos + invader.xPrevious)/2.0f, (invader.yPos + invader.yPrevious)/2.0f, INVADER_HIT_HALF_WIDTH + marchX, INVADER_HIT_HALF_HEIGHT + marchY);
+    }
+}
+
+int BulletCollisions::TestBullets(Pool<Entity> &invaders, Pool<Entity> &bullets, float elapsed) {
+    if (invaders.Size() == 0 || bullets.Size() == 0) {
+        return 0;
+    }
+    
+    hitInvaders.clear();
+    hitBullets.clear();
+    for (size_t z = 0; z < bullets.Size(); z++) {
+        Entity &bullet = bullets[z];
+        float travelX = bullet.xVelocity * elapsed/2.0f;
+        float travelY = bullet.yVelocity * elapsed/2.0f;
+        grid.QueryBox(bullet.xPos - travelX, bullet.yPos - travelY, fabsf(travelX), fabsf(travelY), candidates);
+        
+        // bullets are points, a bullet stops at the first invader it reaches
+        MovingBox bulletBox = RewoundBox(bullet.xPos - travelX*2.0f, bullet.yPos - travelY*2.0f, bullet.xPos, bullet.yPos, 0.0f, 0.0f, elapsed);
+        int firstHit = -1;
+        float firstTime = 2.0f;
+        for (unsigned int w: candidates) {
+            if (invaderHit[w]) {
+                continue;
+            }
+            MovingBox invaderBox = RewoundBox(invaders[w].xPrevious, invaders[w].yPrevious, invaders[w].xPos, invaders[w].yPos, INVADER_HIT_HALF_WIDTH*2.0f, INVADER_HIT_HALF_HEIGHT*2.0f, elapsed);
+            Impact impact;
+            if (SweepBoxes(bulletBox, invaderBox, elapsed, impact) && impact.time < firstTime) {
+                firstHit = (int)w;
+                firstTime = impact.time;
+            }
+        }
+        if (firstHit >= 0) {
+            invaderHit[firstHit] = 1;
+            hitInvaders.push_back(invaders.HandleAt(firstHit));
+            hitBullets.push_back(bullets.HandleAt(z));
+        }
+    }
+    
+    // handles stay valid while other items move into the despawned slots
+    for (size_t i = 0; i < hitInvaders.size(); i++) {
+        invaders.Despawn(hitInvaders[i]);
+        bullets.Despawn(hitBullets[i]);
+    }
+    return (int)hitInvaders.size();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+#include "Entity.h"
+#include "HandlePool.h"
+#include "CollisionGrid.h"
+
+// half extents of the box a bullet has to enter to hit an invader
+#define INVADER_HIT_HALF_WIDTH 0.1075f
+#define INVADER_HIT_HALF_HEIGHT 0.115f
+// distance between neighbouring invaders in the formation
+#define FORMATION_SPACING_X 0.4f
+#define FORMATION_SPACING_Y 0.3f
+
+// moves the formation sideways, turning it around and down a row at the screen edges,
+// after saving each invader's position as its previous one.
+// returns true once any invader has come down to the ship's height
+bool MarchInvaders(Pool<Entity> &invaders, float elapsed, float shipY);
+
+// moves bullets up and despawns the ones that have been flying for two seconds
+void UpdateBullets(Pool<Entity> &bullets, float elapsed);
+
+// Bullet vs invader test that bins the invaders into a grid over the formation and
+// checks each bullet against the cells its path crossed this frame. The test is swept,
+// so a long frame cannot carry a bullet through an invader. Hits are only marked during
+// the test and the hit invaders and bullets are despawned together in one pass afterwards.
+class BulletCollisions {
+    public:
+
+        // positions are where everything ended the frame, returns the number of invaders hit
+        int Check(Pool<Entity> &invaders, Pool<Entity> &bullets, float elapsed);
+
+        // the two halves of Check. The grid's cells are sized from the formation's
+        // bounds and count, so a bullet's cost does not grow with the formation
+        void BuildGrid(Pool<Entity> &invaders);
+        // despawns what was hit, the grid has to be rebuilt before testing again
+        int TestBullets(Pool<Entity> &invaders, Pool<Entity> &bullets, float elapsed);
+
+        CollisionGrid grid;
+        std::vector<unsigned int> candidates;
+        std::vector<char> invaderHit;
+        std::vector<Handle> hitInvaders;
+        std::vector<Handle> hitBullets;
+};
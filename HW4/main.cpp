@@ -6,9 +6,10 @@
 #include <SDL_image.h>
 
 #define STB_IMAGE_IMPLEMENTATION
-#include "FlareMap.h"
+#include "LevelMap.h"
 #include "stb_image.h"
 #include "ShaderProgram.h"
+#include "TextureManager.h"
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include <cmath>
@@ -25,23 +26,6 @@ SDL_Window* displayWindow;
 
 using namespace std;
 
-GLuint LoadTexture(const char *filePath) {
-    int w,h,comp;
-    unsigned char* image = stbi_load(filePath, &w, &h, &comp, STBI_rgb_alpha);
-    if(image == NULL) {
-        std::cout << "Unable to load image. Make sure the path is correct\n";
-        assert(false);
-    }
-    GLuint retTexture;
-    glGenTextures(1, &retTexture);
-    glBindTexture(GL_TEXTURE_2D, retTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    stbi_image_free(image);
-    return retTexture;
-}
-
 struct Vec2 {
     float x, y;
     Vec2(float x, float y): x(x), y(y) {}
@@ -145,7 +129,7 @@ int main(int argc, char *argv[])
     
     ShaderProgram program;
     program.Load(RESOURCE_FOLDER"vertex_textured.glsl", RESOURCE_FOLDER"fragment_textured.glsl");
-    glUseProgram(program.programID);
+    program.Use();
     
     glm::mat4 projectionMatrix = glm::mat4(1.0f);
     glm::mat4 viewMatrix = glm::mat4(1.0f);
@@ -160,15 +144,22 @@ int main(int argc, char *argv[])
     float accumulator = 0.0f;
     const Uint8 *keys = SDL_GetKeyboardState(NULL);
     
-    GLuint spriteSheet = LoadTexture(RESOURCE_FOLDER"spritesheet.png");
+    TextureManager textures;
+    GLuint spriteSheet = textures.Get(textures.Acquire(RESOURCE_FOLDER"spritesheet.png"));
     Entity player  = Entity(Vec2(2.3, -2.5), 0.635, 0.01);
     Entity coin1 = Entity(Vec2(2.8, -2.6), 0.6, 0.13);
     Entity coin2 = Entity(Vec2(4.7, -2.6), 0.6, 0.13);
     Entity coin3 = Entity(Vec2(3.8, -2.4), 0.6, 0.13);
-    FlareMap map;
+    LevelMap map;
     vector<Entity> tiles;
     
-    map.Load(RESOURCE_FOLDER"TileMap3.txt");
+    //compiled from TileMap3.txt by MapCompiler, the tiles are read straight out of the mapped file
+    //the text is parsed instead while the .map is missing or out of date
+    if (!map.Load(RESOURCE_FOLDER"TileMap3.map", RESOURCE_FOLDER"TileMap3.txt")){
+        textures.Cleanup();
+        SDL_Quit();
+        return 1;
+    }
     for(int x=0; x < map.mapWidth; x++) {
         for(int y=0; y < map.mapHeight; y++) {
          // check map.mapData[y][x] for tile index
@@ -316,6 +307,7 @@ int main(int argc, char *argv[])
         SDL_GL_SwapWindow(displayWindow);
     }
     
+    textures.Cleanup();
     SDL_Quit();
     return 0;
 }
@@ -0,0 +1,149 @@
+#include "TileCollision.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <string>
+#include <cmath>
+
+// boxes resting exactly on a tile edge are not inside that tile
+#define TILE_EPSILON 0.0001f
+
+TileCollision::TileCollision(): mapWidth(0), mapHeight(0), tileSize(1.0f), wordsPerRow(0) {}
+
+bool TileCollision::LoadTileset(const char *path) {
+    std::ifstream infile(path);
+    if (infile.fail()) {
+        std::cout << "Unable to open tileset " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(infile, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream stream(line);
+        std::string property;
+        stream >> property;
+        if (property != "solid") {
+            std::cout << "Unknown tile property " << property << " in " << path << std::endl;
+            continue;
+        }
+        unsigned int tileId;
+        while (stream >> tileId) {
+            SetSolid(tileId);
+        }
+    }
+    return true;
+}
+
+void TileCollision::SetSolid(unsigned int tileId, bool solid) {
+    if (tileId >= solidTiles.size()) {
+        solidTiles.resize(tileId + 1, false);
+    }
+    solidTiles[tileId] = solid;
+}
+
+void TileCollision::Build(const unsigned int *const *mapData, int mapWidth, int mapHeight, float tileSize) {
+    this->mapWidth = mapWidth;
+    this->mapHeight = mapHeight;
+    this->tileSize = tileSize;
+    wordsPerRow = (mapWidth + 63) / 64;
+    solidBits.assign((size_t)wordsPerRow * mapHeight, 0);
+    for (int y = 0; y < mapHeight; y++) {
+        for (int x = 0; x < mapWidth; x++) {
+            unsigned int tileId = mapData[y][x];
+            if (tileId < solidTiles.size() && solidTiles[tileId]) {
+                solidBits[(size_t)y * wordsPerRow + x / 64] |= (uint64_t)1 << (x % 64);
+            }
+        }
+    }
+}
+
+bool TileCollision::IsSolid(int tileX, int tileY) const {
+    // everything outside the level is open, falling off the map is up to the game
+    if (tileX < 0 || tileX >= mapWidth || tileY < 0 || tileY >= mapHeight) {
+        return false;
+    }
+    return (solidBits[(size_t)tileY * wordsPerRow + tileX / 64] >> (tileX % 64)) & 1;
+}
+
+int TileCollision::TileX(float x) const {
+    return (int)floorf(x / tileSize + 0.5f);
+}
+
+int TileCollision::TileY(float y) const {
+    return (int)floorf(-y / tileSize + 0.5f);
+}
+
+bool TileCollision::IsSolidAt(float x, float y) const {
+    return IsSolid(TileX(x), TileY(y));
+}
+
+void TileCollision::Move(float &x, float &y, float halfWidth, float halfHeight, float dx, float dy, TileContacts &contacts) const {
+    contacts.left = contacts.right = contacts.top = contacts.bottom = false;
+
+    if (dx != 0.0f) {
+        // rows the box covers, walked column by column along the path
+        int firstRow = TileY(y + halfHeight - TILE_EPSILON);
+        int lastRow = TileY(y - halfHeight + TILE_EPSILON);
+        float edge = dx > 0.0f ? x + halfWidth : x - halfWidth;
+        int step = dx > 0.0f ? 1 : -1;
+        int column = TileX(edge - step * TILE_EPSILON);
+        int lastColumn = TileX(edge + dx);
+        bool blocked = false;
+        for (; !blocked; column += step) {
+            for (int row = firstRow; row <= lastRow && !blocked; row++) {
+                if (!IsSolid(column, row)) {
+                    continue;
+                }
+                // the near side of the tile, skipped if the box is already past it
+                float wall = column * tileSize - step * tileSize / 2.0f;
+                if ((wall - edge) * step >= -TILE_EPSILON) {
+                    x = wall - step * halfWidth;
+                    blocked = true;
+                }
+            }
+            if (column == lastColumn) {
+                break;
+            }
+        }
+        if (blocked) {
+            contacts.right = dx > 0.0f;
+            contacts.left = dx < 0.0f;
+        } else {
+            x += dx;
+        }
+    }
+
+    if (dy != 0.0f) {
+        int firstColumn = TileX(x - halfWidth + TILE_EPSILON);
+        int lastColumn = TileX(x + halfWidth - TILE_EPSILON);
+        float edge = dy > 0.0f ? y + halfHeight : y - halfHeight;
+        // rows count downwards, so moving up walks towards row 0
+        int step = dy > 0.0f ? -1 : 1;
+        int row = TileY(edge + step * TILE_EPSILON);
+        int lastRow = TileY(edge + dy);
+        bool blocked = false;
+        for (; !blocked; row += step) {
+            for (int column = firstColumn; column <= lastColumn && !blocked; column++) {
+                if (!IsSolid(column, row)) {
+                    continue;
+                }
+                float wall = -row * tileSize + step * tileSize / 2.0f;
+                if ((edge - wall) * step >= -TILE_EPSILON) {
+                    y = wall + step * halfHeight;
+                    blocked = true;
+                }
+            }
+            if (row == lastRow) {
+                break;
+            }
+        }
+        if (blocked) {
+            contacts.top = dy > 0.0f;
+            contacts.bottom = dy < 0.0f;
+        } else {
+            y += dy;
+        }
+    }
+}
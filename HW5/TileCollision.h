@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+// sides of a box that ran into a solid tile during a move
+struct TileContacts {
+    bool left;
+    bool right;
+    bool top;
+    bool bottom;
+};
+
+// Solid tiles of a FlareMap level packed into one bit per tile, with boxes
+// moved through the level one axis at a time. A move only looks at the tiles
+// under the box's path, so its cost depends on how far the box travels and
+// not on the size of the level. Tile (x, y) is centred at (x * tileSize, -y * tileSize),
+// the same layout TileLayer draws.
+class TileCollision {
+    public:
+
+        TileCollision();
+
+        // reads "solid <tile id>..." lines, ids are the tile values FlareMap stores
+        bool LoadTileset(const char *path);
+        void SetSolid(unsigned int tileId, bool solid = true);
+        void Build(const unsigned int *const *mapData, int mapWidth, int mapHeight, float tileSize);
+
+        bool IsSolid(int tileX, int tileY) const;
+        bool IsSolidAt(float x, float y) const;
+
+        // moves the box centred at (x, y) by (dx, dy), horizontally first, and stops it flush against solid tiles
+        void Move(float &x, float &y, float halfWidth, float halfHeight, float dx, float dy, TileContacts &contacts) const;
+
+        int mapWidth;
+        int mapHeight;
+        float tileSize;
+
+    private:
+
+        int TileX(float x) const;
+        int TileY(float y) const;
+
+        // solidity by tile id, from the tileset
+        std::vector<bool> solidTiles;
+        // one bit per map tile, rows padded to whole words
+        std::vector<uint64_t> solidBits;
+        int wordsPerRow;
+};
@@ -0,0 +1,132 @@
+#include "TileLayer.h"
+#include "glm/gtc/matrix_transform.hpp"
+#include "glm/matrix.hpp"
+#include <algorithm>
+#include <cmath>
+
+// x, y, u, v per vertex
+#define FLOATS_PER_VERTEX 4
+
+TileLayer::TileLayer(): mapWidth(0), mapHeight(0), chunksX(0), chunksY(0), drawnChunks(0) {}
+
+void TileLayer::Build(const unsigned int *const *mapData, int mapWidth, int mapHeight) {
+    Cleanup();
+    
+    this->mapWidth = mapWidth;
+    this->mapHeight = mapHeight;
+    chunksX = (mapWidth + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    chunksY = (mapHeight + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    chunks.resize(chunksX * chunksY);
+    
+    std::vector<float> vertexData;
+    vertexData.reserve(CHUNK_SIZE * CHUNK_SIZE * 6 * FLOATS_PER_VERTEX);
+    
+    for (int chunkY = 0; chunkY < chunksY; chunkY++) {
+        for (int chunkX = 0; chunkX < chunksX; chunkX++) {
+            vertexData.clear();
+            int endY = std::min((chunkY + 1) * CHUNK_SIZE, mapHeight);
+            int endX = std::min((chunkX + 1) * CHUNK_SIZE, mapWidth);
+            for (int y = chunkY * CHUNK_SIZE; y < endY; y++) {
+                for (int x = chunkX * CHUNK_SIZE; x < endX; x++) {
+                    int tileIndex = mapData[y][x];
+                    float u = (float)(tileIndex % SPRITE_COUNT_X) / SPRITE_COUNT_X + 1.0f/372.0f;
+                    float v = (float)(tileIndex / SPRITE_COUNT_X) / SPRITE_COUNT_Y + 3.0f/372.0f;
+                    
+                    // tile (x, y) is centered at (x * TILE_SIZE, -y * TILE_SIZE)
+                    float left = x * TILE_SIZE - TILE_SIZE * 0.5f;
+                    float right = left + TILE_SIZE;
+                    float top = -y * TILE_SIZE + TILE_SIZE * 0.5f;
+                    float bottom = top - TILE_SIZE;
+                    
+                    vertexData.insert(vertexData.end(), {
+                        left, bottom, u, v + TILE_UV_HEIGHT,
+                        right, bottom, u + TILE_UV_WIDTH, v + TILE_UV_HEIGHT,
+                        right, top, u + TILE_UV_WIDTH, v,
+                        left, bottom, u, v + TILE_UV_HEIGHT,
+                        right, top, u + TILE_UV_WIDTH, v,
+                        left, top, u, v
+                    });
+                }
+            }
+            
+            TileChunk &chunk = chunks[chunkY * chunksX + chunkX];
+            chunk.vertexCount = (int)(vertexData.size() / FLOATS_PER_VERTEX);
+            glGenBuffers(1, &chunk.vertexBuffer);
+            glBindBuffer(GL_ARRAY_BUFFER, chunk.vertexBuffer);
+            glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(float), vertexData.data(), GL_STATIC_DRAW);
+        }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void TileLayer::Draw(ShaderProgram &program, const glm::mat4 &projectionMatrix, const glm::mat4 &viewMatrix) {
+    drawnChunks = 0;
+    if (chunks.empty()) {
+        return;
+    }
+    
+    // unproject the corners of clip space to get the visible world rectangle
+    glm::mat4 inverseViewProjection = glm::inverse(projectionMatrix * viewMatrix);
+    float minX = INFINITY, maxX = -INFINITY, minY = INFINITY, maxY = -INFINITY;
+    for (int corner = 0; corner < 4; corner++) {
+        glm::vec4 world = inverseViewProjection * glm::vec4(corner & 1 ? 1.0f : -1.0f, corner & 2 ? 1.0f : -1.0f, 0.0f, 1.0f);
+        minX = std::min(minX, world.x / world.w);
+        maxX = std::max(maxX, world.x / world.w);
+        minY = std::min(minY, world.y / world.w);
+        maxY = std::max(maxY, world.y / world.w);
+    }
+    
+    // world rectangle to tile range, rows grow downwards
+    float chunkWorldSize = CHUNK_SIZE * TILE_SIZE;
+    int firstChunkX = std::max(0, (int)floorf((minX + TILE_SIZE * 0.5f) / chunkWorldSize));
+    int lastChunkX = std::min(chunksX - 1, (int)floorf((maxX + TILE_SIZE * 0.5f) / chunkWorldSize));
+    int firstChunkY = std::max(0, (int)floorf((-maxY + TILE_SIZE * 0.5f) / chunkWorldSize));
+    int lastChunkY = std::min(chunksY - 1, (int)floorf((-minY + TILE_SIZE * 0.5f) / chunkWorldSize));
+    if (firstChunkX > lastChunkX || firstChunkY > lastChunkY) {
+        return;
+    }
+    
+    DrawChunks(program, firstChunkX, lastChunkX, firstChunkY, lastChunkY);
+}
+
+void TileLayer::DrawAll(ShaderProgram &program) {
+    drawnChunks = 0;
+    if (chunks.empty()) {
+        return;
+    }
+    DrawChunks(program, 0, chunksX - 1, 0, chunksY - 1);
+}
+
+void TileLayer::DrawChunks(ShaderProgram &program, int firstChunkX, int lastChunkX, int firstChunkY, int lastChunkY) {
+    program.SetModelMatrix(glm::mat4(1.0f));
+    glEnableVertexAttribArray(program.positionAttribute);
+    glEnableVertexAttribArray(program.texCoordAttribute);
+    
+    for (int chunkY = firstChunkY; chunkY <= lastChunkY; chunkY++) {
+        for (int chunkX = firstChunkX; chunkX <= lastChunkX; chunkX++) {
+            DrawChunk(program, chunks[chunkY * chunksX + chunkX]);
+        }
+    }
+    
+    glDisableVertexAttribArray(program.positionAttribute);
+    glDisableVertexAttribArray(program.texCoordAttribute);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void TileLayer::DrawChunk(ShaderProgram &program, const TileChunk &chunk) {
+    glBindBuffer(GL_ARRAY_BUFFER, chunk.vertexBuffer);
+    GLsizei stride = FLOATS_PER_VERTEX * sizeof(float);
+    glVertexAttribPointer(program.positionAttribute, 2, GL_FLOAT, false, stride, (void*)0);
+    glVertexAttribPointer(program.texCoordAttribute, 2, GL_FLOAT, false, stride, (void*)(2 * sizeof(float)));
+    glDrawArrays(GL_TRIANGLES, 0, chunk.vertexCount);
+    drawnChunks++;
+}
+
+void TileLayer::Cleanup() {
+    for (size_t i = 0; i < chunks.size(); i++) {
+        glDeleteBuffers(1, &chunks[i].vertexBuffer);
+    }
+    chunks.clear();
+    chunksX = chunksY = 0;
+    drawnChunks = 0;
+}
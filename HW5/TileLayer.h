@@ -0,0 +1,52 @@
+#pragma once
+
+#ifdef _WINDOWS
+	#include <GL/glew.h>
+#endif
+#include <SDL_opengl.h>
+#include <vector>
+#include "ShaderProgram.h"
+
+// spritesheet.png layout and world size of one tile
+#define SPRITE_COUNT_X 30
+#define SPRITE_COUNT_Y 16
+#define TILE_SIZE 0.3f
+#define TILE_UV_WIDTH 0.03f
+#define TILE_UV_HEIGHT 0.056f
+
+// tiles per side of one chunk buffer
+#define CHUNK_SIZE 32
+
+struct TileChunk {
+    GLuint vertexBuffer;
+    int vertexCount;
+};
+
+// A FlareMap tile layer baked into immutable vertex buffers of world-space quads,
+// one per CHUNK_SIZE x CHUNK_SIZE block so only the chunks on screen get drawn.
+class TileLayer {
+    public:
+    
+        TileLayer();
+    
+        void Build(const unsigned int *const *mapData, int mapWidth, int mapHeight);
+        // draws the chunks the view can see
+        void Draw(ShaderProgram &program, const glm::mat4 &projectionMatrix, const glm::mat4 &viewMatrix);
+        // draws every chunk, to measure what culling saves
+        void DrawAll(ShaderProgram &program);
+        void Cleanup();
+    
+        int mapWidth;
+        int mapHeight;
+        int chunksX;
+        int chunksY;
+        std::vector<TileChunk> chunks;
+    
+        // chunks submitted by the last Draw
+        int drawnChunks;
+    
+    private:
+    
+        void DrawChunks(ShaderProgram &program, int firstChunkX, int lastChunkX, int firstChunkY, int lastChunkY);
+        void DrawChunk(ShaderProgram &program, const TileChunk &chunk);
+};
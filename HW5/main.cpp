@@ -6,43 +6,37 @@
 #include <SDL_image.h>
 
 #define STB_IMAGE_IMPLEMENTATION
-#include "FlareMap.h"
+#include "LevelMap.h"
 #include "stb_image.h"
 #include "ShaderProgram.h"
+#include "TextureManager.h"
+#include "TileLayer.h"
+#include "TileCollision.h"
+#include "Headless.h"
+#include "GameLoop.h"
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include <SDL_mixer.h>
 #include <cmath>
 #include <vector>
+#include <string>
 #ifdef _WINDOWS
 #define RESOURCE_FOLDER ""
 #else
 #define RESOURCE_FOLDER "NYUCodebase.app/Contents/Resources/"
+#endif
 #define FIXED_TIMESTEP 0.0166666f
 #define MAX_TIMESTEPS 6
-#endif
+#define GRAVITY -2.5f
+//collision box of the player sprite, which has a transparent margin at the sides
+#define PLAYER_HALF_WIDTH 0.12f
+#define PLAYER_HALF_HEIGHT 0.15f
 
 SDL_Window* displayWindow;
+HeadlessContext headless;
 
 using namespace std;
 
-GLuint LoadTexture(const char *filePath) {
-    int w,h,comp;
-    unsigned char* image = stbi_load(filePath, &w, &h, &comp, STBI_rgb_alpha);
-    if(image == NULL) {
-        std::cout << "Unable to load image. Make sure the path is correct\n";
-        assert(false);
-    }
-    GLuint retTexture;
-    glGenTextures(1, &retTexture);
-    glBindTexture(GL_TEXTURE_2D, retTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    stbi_image_free(image);
-    return retTexture;
-}
-
 struct Vec2 {
     float x, y;
     Vec2(float x, float y): x(x), y(y) {}
@@ -62,6 +56,8 @@ public:
     bool collected;
 
     Vec2 position;
+    //position before the last simulation step
+    Vec2 previousPosition;
     Vec2 velocity;
     Vec2 acceleration;
     
@@ -71,7 +67,7 @@ public:
     float u;
     float v;
     
-    Entity(Vec2 pos, float u, float v): u(u), v(v), position(pos),  velocity(0, 0), acceleration(0, 0), collected(false){}
+    Entity(Vec2 pos, float u, float v): isTouchingGround(false), collidedRight(false), collidedLeft(false), u(u), v(v), position(pos), previousPosition(pos), velocity(0, 0), acceleration(0, 0), collected(false){}
     
     bool isInContact(Entity &otherEntity){
 
@@ -85,12 +81,18 @@ public:
         }
     }
     
-    void Draw(ShaderProgram &program){
+    //position blended from the previous to the current step, see GameLoop::Alpha
+    Vec2 DrawPosition(float alpha){
+        return Vec2(lerp(previousPosition.x, position.x, alpha), lerp(previousPosition.y, position.y, alpha));
+    }
+    
+    void Draw(ShaderProgram &program, float alpha = 1.0f){
         #define DEFAULT_VERTICES {-0.5, -0.5, 0.5, -0.5, 0.5, 0.5,-0.5, -0.5, 0.5, 0.5, -0.5, 0.5}
 
         glm::mat4 modelMatrix = glm::mat4(1.0f);
+        Vec2 drawPosition = DrawPosition(alpha);
    
-        modelMatrix = glm::translate(modelMatrix, glm::vec3(position.x, position.y, 0.0f));
+        modelMatrix = glm::translate(modelMatrix, glm::vec3(drawPosition.x, drawPosition.y, 0.0f));
         modelMatrix = glm::scale(modelMatrix, glm::vec3(0.3, 0.3, 1.0f));
     
         program.SetModelMatrix(modelMatrix);
@@ -114,40 +116,158 @@ public:
     }
 };
 
-void Setup(){
-    SDL_Init(SDL_INIT_VIDEO);
-    displayWindow = SDL_CreateWindow("Platformer Demo", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 640, 360, SDL_WINDOW_OPENGL);
-    SDL_GLContext context = SDL_GL_CreateContext(displayWindow);
-    SDL_GL_MakeCurrent(displayWindow, context);
-    
-    #ifdef _WINDOWS
-    glewInit();
-    #endif
-    
-    glViewport(0, 0, 640, 360);
+void Setup(bool isHeadless){
+    if (isHeadless){
+        #ifdef HEADLESS_EGL
+        SDL_Init(SDL_INIT_TIMER);
+        #else
+        SDL_Init(SDL_INIT_VIDEO);
+        #endif
+        if (!headless.Create(640, 360)){
+            exit(1);
+        }
+    }
+    else{
+        SDL_Init(SDL_INIT_VIDEO);
+        displayWindow = SDL_CreateWindow("Platformer Demo", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 640, 360, SDL_WINDOW_OPENGL);
+        SDL_GLContext context = SDL_GL_CreateContext(displayWindow);
+        SDL_GL_MakeCurrent(displayWindow, context);
+        //frames are paced by the display, the game loop keeps the simulation at a fixed rate
+        SDL_GL_SetSwapInterval(1);
+        
+        #ifdef _WINDOWS
+        glewInit();
+        #endif
+        
+        glViewport(0, 0, 640, 360);
+        Mix_OpenAudio( 44100, MIX_DEFAULT_FORMAT, 2, 4096 );
+    }
     
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    Mix_OpenAudio( 44100, MIX_DEFAULT_FORMAT, 2, 4096 );
-
 }
-void Update(float elapsed, Entity &player){
+//integrates the player and moves it through the level, stopping at solid tiles
+void Update(float elapsed, Entity &player, const TileCollision &tiles){
     player.velocity.x += player.acceleration.x * elapsed;
     player.velocity.y += player.acceleration.y * elapsed;
-    player.position.x += player.velocity.x * elapsed;
-    player.position.y += player.velocity.y * elapsed;
+    
+    TileContacts contacts;
+    tiles.Move(player.position.x, player.position.y, PLAYER_HALF_WIDTH, PLAYER_HALF_HEIGHT, player.velocity.x * elapsed, player.velocity.y * elapsed, contacts);
+    player.collidedRight = contacts.right;
+    player.collidedLeft = contacts.left;
+    player.isTouchingGround = contacts.bottom;
+    if (contacts.bottom || contacts.top){
+        player.velocity.y = 0.0f;
+    }
+    
     player.velocity.x = lerp(player.velocity.x, 0.0f, elapsed * 2.0);
     player.velocity.y = lerp(player.velocity.y, 0.0f, elapsed * 2.0);
+    
+    //player has fallen
+    if (player.position.y < -4.5f){
+        player.position.y = -2.5f;
+        player.position.x = 2.3f;
+        player.previousPosition = player.position;
+    }
+}
+
+double MillisecondsPerFrame(Uint64 start, int frames){
+    return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency() / frames;
+}
+
+// times the per-tile Entity path against the chunked TileLayer on synthetic square maps, with the
+// camera in the middle of the map. Both draw the same screenful, so the first comparison is only
+// what batching saves; drawing every chunk against the culled chunks is what culling saves.
+void BenchmarkTileLayer(ShaderProgram &program, GLuint spriteSheet, const glm::mat4 &projectionMatrix){
+    const int sizes[] = {20, 256, 2048};
+    const unsigned int tileIds[] = {177, 122, 152};
+    const int frames = 60;
+    
+    //an orthographic projection shows this far either side of the camera
+    float halfWidth = 1.0f / projectionMatrix[0][0];
+    float halfHeight = 1.0f / projectionMatrix[1][1];
+    
+    glBindTexture(GL_TEXTURE_2D, spriteSheet);
+    for (int size: sizes){
+        vector<unsigned int> tileData((size_t)size * size);
+        vector<unsigned int*> rows(size);
+        for (int y = 0; y < size; y++){
+            rows[y] = &tileData[(size_t)y * size];
+            for (int x = 0; x < size; x++){
+                rows[y][x] = tileIds[rand() % 3];
+            }
+        }
+        
+        float cameraX = size * 0.5f * TILE_SIZE;
+        float cameraY = -size * 0.5f * TILE_SIZE;
+        glm::mat4 viewMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(-cameraX, -cameraY, 0.0f));
+        program.SetViewMatrix(viewMatrix);
+        
+        //tiles overlapping the screen, tile (x, y) is centered at (x * TILE_SIZE, -y * TILE_SIZE)
+        int firstX = max(0, (int)floorf((cameraX - halfWidth + TILE_SIZE * 0.5f) / TILE_SIZE));
+        int lastX = min(size - 1, (int)floorf((cameraX + halfWidth + TILE_SIZE * 0.5f) / TILE_SIZE));
+        int firstY = max(0, (int)floorf((-cameraY - halfHeight + TILE_SIZE * 0.5f) / TILE_SIZE));
+        int lastY = min(size - 1, (int)floorf((-cameraY + halfHeight + TILE_SIZE * 0.5f) / TILE_SIZE));
+        int visibleTiles = (lastX - firstX + 1) * (lastY - firstY + 1);
+        
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int frame = 0; frame < frames; frame++){
+            glClear(GL_COLOR_BUFFER_BIT);
+            for (int y = firstY; y <= lastY; y++){
+                for (int x = firstX; x <= lastX; x++){
+                    int tileIndex = rows[y][x];
+                    Entity tile = Entity(Vec2(x*TILE_SIZE, -y*TILE_SIZE), (float)(tileIndex % SPRITE_COUNT_X)/SPRITE_COUNT_X + 1.0/372.0, (float)(tileIndex / SPRITE_COUNT_X)/SPRITE_COUNT_Y + 3.0/372.0);
+                    tile.Draw(program);
+                }
+            }
+            glFinish();
+        }
+        double entityMs = MillisecondsPerFrame(start, frames);
+        
+        start = SDL_GetPerformanceCounter();
+        TileLayer layer;
+        layer.Build(rows.data(), size, size);
+        glFinish();
+        double buildMs = MillisecondsPerFrame(start, 1);
+        
+        start = SDL_GetPerformanceCounter();
+        for (int frame = 0; frame < frames; frame++){
+            glClear(GL_COLOR_BUFFER_BIT);
+            layer.Draw(program, projectionMatrix, viewMatrix);
+            glFinish();
+        }
+        double culledMs = MillisecondsPerFrame(start, frames);
+        int culledChunks = layer.drawnChunks;
+        
+        //every chunk of the big map is millions of vertices, a few frames are enough
+        int allFrames = size >= 2048 ? 2 : frames;
+        start = SDL_GetPerformanceCounter();
+        for (int frame = 0; frame < allFrames; frame++){
+            glClear(GL_COLOR_BUFFER_BIT);
+            layer.DrawAll(program);
+            glFinish();
+        }
+        double allMs = MillisecondsPerFrame(start, allFrames);
+        
+        cout << size << "x" << size << " (build " << buildMs << " ms)" << endl;
+        cout << "  batching, one screen: per-tile " << entityMs << " ms/frame (" << visibleTiles << " draws), chunked " << culledMs << " ms/frame (" << culledChunks << " draws)" << endl;
+        cout << "  culling: all " << layer.chunks.size() << " chunks " << allMs << " ms/frame, " << culledChunks << " visible chunks " << culledMs << " ms/frame" << endl;
+        layer.Cleanup();
+    }
+    program.SetViewMatrix(glm::mat4(1.0f));
 }
 
 int main(int argc, char *argv[])
 {
-
-    Setup();
+    //--headless renders offscreen for --frames frames and reports frame times
+    bool isHeadless = IsHeadless(argc, argv);
+    int headlessFrames = HeadlessFrameCount(argc, argv, 600);
+    
+    Setup(isHeadless);
     
     ShaderProgram program;
     program.Load(RESOURCE_FOLDER"vertex_textured.glsl", RESOURCE_FOLDER"fragment_textured.glsl");
-    glUseProgram(program.programID);
+    program.Use();
     
     glm::mat4 projectionMatrix = glm::mat4(1.0f);
     glm::mat4 viewMatrix = glm::mat4(1.0f);
@@ -158,19 +278,48 @@ int main(int argc, char *argv[])
 
     program.SetProjectionMatrix(projectionMatrix);
     
-    float lastFrameTicks = 0.0f;
-    float accumulator = 0.0f;
+    FrameTimes frameTimes;
+    frameTimes.Reserve(headlessFrames);
+    int frameCount = 0;
+    GameLoop loop(1.0f/FIXED_TIMESTEP, 0.0f, MAX_TIMESTEPS);
     const Uint8 *keys = SDL_GetKeyboardState(NULL);
     
-    GLuint spriteSheet = LoadTexture(RESOURCE_FOLDER"spritesheet.png");
+    TextureManager textures;
+    GLuint spriteSheet = textures.Get(textures.Acquire(RESOURCE_FOLDER"spritesheet.png"));
     Entity player  = Entity(Vec2(2.3, -2.5), 0.635, 0.01);
     Entity coin1 = Entity(Vec2(2.8, -2.6), 0.6, 0.13);
     Entity coin2 = Entity(Vec2(4.7, -2.6), 0.6, 0.13);
     Entity coin3 = Entity(Vec2(3.8, -2.4), 0.6, 0.13);
-    FlareMap map;
-    vector<Entity> tiles;
+    player.acceleration.y = GRAVITY;
+    LevelMap map;
+    TileLayer tileLayer;
+    TileCollision tileCollision;
     
-    map.Load(RESOURCE_FOLDER"TileMap3.txt");
+    //compiled from TileMap3.txt by MapCompiler, the tiles are read straight out of the mapped file
+    //the text is parsed instead while the .map is missing or out of date
+    if (!map.Load(RESOURCE_FOLDER"TileMap3.map", RESOURCE_FOLDER"TileMap3.txt")){
+        textures.Cleanup();
+        if (isHeadless){
+            headless.Destroy();
+        }
+        SDL_Quit();
+        return 1;
+    }
+    tileLayer.Build(map.mapData, map.mapWidth, map.mapHeight);
+    //which tiles are solid comes from the tileset, not from the level
+    tileCollision.LoadTileset(RESOURCE_FOLDER"spritesheet.tileset");
+    tileCollision.Build(map.mapData, map.mapWidth, map.mapHeight, TILE_SIZE);
+    
+    if (HasFlag(argc, argv, "--bench-tiles")){
+        BenchmarkTileLayer(program, spriteSheet, projectionMatrix);
+        tileLayer.Cleanup();
+        textures.Cleanup();
+        if (isHeadless){
+            headless.Destroy();
+        }
+        SDL_Quit();
+        return 0;
+    }
     
     Mix_Chunk *jumpSound;
     jumpSound = Mix_LoadWAV(RESOURCE_FOLDER"jump.wav");
@@ -180,29 +329,16 @@ int main(int argc, char *argv[])
     Mix_Music *backgroundMusic;
     backgroundMusic = Mix_LoadMUS(RESOURCE_FOLDER"music.mp3");
     Mix_PlayMusic(backgroundMusic, -1);
-    for(int x=0; x < map.mapWidth; x++) {
-        for(int y=0; y < map.mapHeight; y++) {
-         // check map.mapData[y][x] for tile index
-          int tileIndex = map.mapData[y][x];
-          float u, v;
-          int a = tileIndex % 30;
-          int b = tileIndex/30;
-          u = (float)a/30 + 1.0/372.0;
-          v = (float)b/16 + 3.0/372.0;
-          Entity tile = Entity(Vec2(x*0.3, -y*0.3), u, v);
-          tiles.push_back(tile);
-        }
-        
-    }
     
     SDL_Event event;
     bool done = false;
     
     while (!done) {
     
-        float ticks = (float)SDL_GetTicks()/1000.0f;
-        float elapsed = ticks - lastFrameTicks;
-        lastFrameTicks = ticks;
+        frameTimes.BeginFrame();
+        
+        //headless runs feed the loop 60 Hz frames regardless of how fast they render
+        int steps = isHeadless ? loop.BeginFrame(1.0f/60.0f) : loop.BeginFrame();
         
         
         while (SDL_PollEvent(&event)) {
@@ -228,17 +364,12 @@ int main(int argc, char *argv[])
             player.velocity.x = 0.0;
         }
       
-        //update with fixed timestep
-        elapsed += accumulator;
-        if(elapsed < FIXED_TIMESTEP) {
-            accumulator = elapsed;
-            continue;
-        }
-        while(elapsed >= FIXED_TIMESTEP) {
-            Update(FIXED_TIMESTEP, player);
-            elapsed -= FIXED_TIMESTEP;
+        //update with fixed timestep, frames without a step due still draw
+        for (int step = 0; step < steps; step++){
+            player.previousPosition = player.position;
+            Update(loop.timestep, player, tileCollision);
         }
-        accumulator = elapsed;
+        float alpha = loop.Alpha();
         
         //rendering
         glClear(GL_COLOR_BUFFER_BIT);
@@ -246,52 +377,7 @@ int main(int argc, char *argv[])
         glBindTexture(GL_TEXTURE_2D, spriteSheet);
         
         
-        for (Entity tile: tiles){
-            tile.Draw(program);
-        }
-        
-        player.collidedRight = false;
-        player.collidedLeft = false;
-        
-        int playerBottomLeftX = abs(player.position.x - 0.0145)/0.3;
-        int playerBottomLeftY = abs(player.position.y - 0.31)/0.3;
-        
-        int playerBottomRightX = abs(player.position.x + 0.25)/0.3;
-        int playerBottomRightY = abs(player.position.y - 0.31)/0.3;
-        
-        int playerMidRightX = (player.position.x + 0.3001)/0.3;
-        int playerMidLeftX = (player.position.x - 0.0145001)/0.3;
-        int playerMidY = (player.position.y - 0.01)/-0.3;
-        int playerMidY2 = (player.position.y - 0.3)/-0.3;
-        
-        
-        //check if player is next to a raised ground tile
-        if (map.mapData[playerMidY][playerMidRightX] == 122 || map.mapData[playerMidY][playerMidRightX] == 152 || map.mapData[playerMidY2][playerMidRightX] == 122){
-            player.collidedRight = true;
-        }
-        if (map.mapData[playerMidY][playerMidLeftX] == 122 || map.mapData[playerMidY][playerMidLeftX] == 152 || map.mapData[playerMidY2][playerMidLeftX] == 122){
-            player.collidedLeft = true;
-        }
-        
-        
-        //check if player is on the ground
-        if (map.mapData[playerBottomLeftY][playerBottomLeftX] == 122 || map.mapData[playerBottomRightY][playerBottomRightX] == 122){
-            player.acceleration.y = 0.0;
-            player.velocity.y = 0.0;
-            
-            player.position.y = player.position.y + 0.0001;
-            player.isTouchingGround = true;
-        }
-        else {
-            player.acceleration.y = -2.5;
-            player.isTouchingGround = false;
-        }
-        
-        //player has fallen
-        if (player.position.y < -4.5f){
-            player.position.y = -2.5f;
-            player.position.x = 2.3f;
-        }
+        tileLayer.Draw(program, projectionMatrix, viewMatrix);
         
         //check coin collisions
         if(coin1.collected == false){
@@ -318,22 +404,41 @@ int main(int argc, char *argv[])
         }
         
         
-        player.Draw(program);
+        player.Draw(program, alpha);
         
         
         
-        if(player.position.x > 2.0f && player.position.x < 4.0f){
+        Vec2 cameraPosition = player.DrawPosition(alpha);
+        if(cameraPosition.x > 2.0f && cameraPosition.x < 4.0f){
         
             viewMatrix = glm::mat4(1.0f);
-            viewMatrix = glm::translate(viewMatrix, glm::vec3(-player.position.x, -player.position.y, 1.0f));
+            viewMatrix = glm::translate(viewMatrix, glm::vec3(-cameraPosition.x, -cameraPosition.y, 1.0f));
             program.SetViewMatrix(viewMatrix);
         }
         
         
 
-        SDL_GL_SwapWindow(displayWindow);
+        if (isHeadless){
+            headless.EndFrame();
+            frameTimes.EndFrame();
+            frameCount++;
+            if (frameCount >= headlessFrames){
+                done = true;
+            }
+        }
+        else{
+            SDL_GL_SwapWindow(displayWindow);
+        }
+        loop.EndFrame();
     }
     
+    //GL objects go before the context that owns them
+    tileLayer.Cleanup();
+    textures.Cleanup();
+    if (isHeadless){
+        frameTimes.Report("HW5");
+        headless.Destroy();
+    }
     SDL_Quit();
     return 0;
 }